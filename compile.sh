@@ -2,4 +2,11 @@
 
 cd src
 
-g++ -o ../bin/simulation main.cpp ClothSimulator.cpp Node.cpp Camera.cpp Constraint.cpp StructuralConstraint.cpp ShearConstraint.cpp Arrow.cpp Sphere.cpp Triangle.cpp Cloth.cpp Floor.cpp Scene.cpp BatmanScene.cpp Keyboard.cpp DrawingSettings.cpp -lglut -lGLU -lGL
+g++ -O2 -pthread -o ../bin/simulation main.cpp ClothSimulator.cpp Node.cpp ParticleStore.cpp Camera.cpp Constraint.cpp VerletIntegrator.cpp ColoredConstraintSolver.cpp WorkerPool.cpp SimulationSettings.cpp SimulationScheduler.cpp Sphere.cpp SphereCollider.cpp SphereGrid.cpp SpatialHashGrid.cpp NeighborList.cpp Triangle.cpp TriangleBvh.cpp Cloth.cpp ClothFrame.cpp ClothMesh.cpp VertexBatch.cpp SphereMesh.cpp SphereBatch.cpp RenderPass.cpp Profiler.cpp PerfCounters.cpp AllocationCounter.cpp Tracer.cpp Floor.cpp Scene.cpp BatmanScene.cpp Keyboard.cpp DrawingSettings.cpp -lglut -lGLU -lGL
+
+# the same program with the phase profiler (--profile-csv, key 9, F7) and the
+# Chrome trace (--trace), which add a few clock reads to every phase
+g++ -O2 -pthread -DENABLE_PROFILER -DENABLE_TRACER -o ../bin/simulation-profile main.cpp ClothSimulator.cpp Node.cpp ParticleStore.cpp Camera.cpp Constraint.cpp VerletIntegrator.cpp ColoredConstraintSolver.cpp WorkerPool.cpp SimulationSettings.cpp SimulationScheduler.cpp Sphere.cpp SphereCollider.cpp SphereGrid.cpp SpatialHashGrid.cpp NeighborList.cpp Triangle.cpp TriangleBvh.cpp Cloth.cpp ClothFrame.cpp ClothMesh.cpp VertexBatch.cpp SphereMesh.cpp SphereBatch.cpp RenderPass.cpp Profiler.cpp PerfCounters.cpp AllocationCounter.cpp Tracer.cpp Floor.cpp Scene.cpp BatmanScene.cpp Keyboard.cpp DrawingSettings.cpp -lglut -lGLU -lGL
+
+g++ -O2 -pthread -DHEADLESS -DENABLE_PROFILER -DENABLE_TRACER -DENABLE_ALLOCATION_COUNTER -o ../bin/headless headless.cpp Node.cpp ParticleStore.cpp Camera.cpp Constraint.cpp VerletIntegrator.cpp ColoredConstraintSolver.cpp WorkerPool.cpp SimulationSettings.cpp Sphere.cpp SphereCollider.cpp SphereGrid.cpp SpatialHashGrid.cpp NeighborList.cpp Triangle.cpp TriangleBvh.cpp Cloth.cpp ClothFrame.cpp ClothMesh.cpp VertexBatch.cpp SphereMesh.cpp SphereBatch.cpp RenderPass.cpp Profiler.cpp PerfCounters.cpp AllocationCounter.cpp Tracer.cpp Scene.cpp BatmanScene.cpp DrawingSettings.cpp
+g++ -O2 -pthread -DHEADLESS -o ../bin/benchmark benchmark.cpp Node.cpp ParticleStore.cpp Camera.cpp Constraint.cpp VerletIntegrator.cpp ColoredConstraintSolver.cpp WorkerPool.cpp SimulationSettings.cpp Sphere.cpp SphereCollider.cpp SphereGrid.cpp SpatialHashGrid.cpp NeighborList.cpp Triangle.cpp TriangleBvh.cpp Cloth.cpp ClothFrame.cpp ClothMesh.cpp VertexBatch.cpp SphereMesh.cpp SphereBatch.cpp RenderPass.cpp Profiler.cpp PerfCounters.cpp AllocationCounter.cpp Tracer.cpp Scene.cpp BatmanScene.cpp DrawingSettings.cpp
@@ -0,0 +1,150 @@
+#include "AllocationCounter.h"
+#include "Profiler.h"
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+
+#include <stdlib.h>
+#include <atomic>
+#include <iostream>
+#include <new>
+
+// room kept in front of each allocation for its size. Keeps the alignment
+// malloc gives
+#define ALLOCATION_HEADER_SIZE 16
+
+static std::atomic<long long> numberAllocations(0);
+static std::atomic<long long> phaseAllocations[ALLOCATION_OUTSIDE_PHASES + 1];
+static std::atomic<long long> allocatedBytes(0);
+static std::atomic<long long> liveBytes(0);
+
+static thread_local int currentPhase = ALLOCATION_OUTSIDE_PHASES;
+
+static void* countedAllocate(std::size_t size)
+{
+    char* block = (char*) malloc(size + ALLOCATION_HEADER_SIZE);
+    if(block == 0)
+    {
+        return 0;
+    }
+
+    *((std::size_t*) block) = size;
+
+    numberAllocations.fetch_add(1, std::memory_order_relaxed);
+    phaseAllocations[currentPhase].fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    liveBytes.fetch_add(size, std::memory_order_relaxed);
+
+    return block + ALLOCATION_HEADER_SIZE;
+}
+
+static void countedFree(void* pointer)
+{
+    if(pointer == 0)
+    {
+        return;
+    }
+
+    char* block = (char*) pointer - ALLOCATION_HEADER_SIZE;
+    liveBytes.fetch_sub(*((std::size_t*) block), std::memory_order_relaxed);
+
+    free(block);
+}
+
+int AllocationCounter::enterPhase(int phase)
+{
+    int previousPhase = currentPhase;
+    currentPhase = phase;
+    return previousPhase;
+}
+
+void AllocationCounter::leavePhase(int previousPhase)
+{
+    currentPhase = previousPhase;
+}
+
+long long AllocationCounter::getNumberAllocations()
+{
+    return numberAllocations.load(std::memory_order_relaxed);
+}
+
+long long AllocationCounter::getNumberAllocations(int phase)
+{
+    return phaseAllocations[phase].load(std::memory_order_relaxed);
+}
+
+long long AllocationCounter::getAllocatedBytes()
+{
+    return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+long long AllocationCounter::getLiveBytes()
+{
+    return liveBytes.load(std::memory_order_relaxed);
+}
+
+void AllocationCounter::showAllocations(long long* counts)
+{
+    for(int phase = 0; phase <= ALLOCATION_OUTSIDE_PHASES; phase += 1)
+    {
+        std::string name = phase == ALLOCATION_OUTSIDE_PHASES ? "outside phases" : Profiler::getPhaseName((ProfilePhase) phase);
+        std::cout << "  " << name << std::string(32 - name.size(), ' ') << ": " << counts[phase] << std::endl;
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    void* pointer = countedAllocate(size);
+    if(pointer == 0)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    countedFree(pointer);
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+// Counts the heap allocations of the whole program, by replacing the global
+// operator new and delete. Each allocation is charged to the profiled phase
+// the allocating thread is in (see PROFILE_SCOPE), so the phases which should
+// not allocate can be checked.
+//
+// Compiled only when ENABLE_ALLOCATION_COUNTER is defined, since every
+// allocation of the program then pays for a header and a few atomic adds. The
+// phases are those of the profiler, so ENABLE_PROFILER is needed too.
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+
+#ifndef ENABLE_PROFILER
+#error "the allocation counter needs ENABLE_PROFILER"
+#endif
+
+// phase of the allocations made outside of any profiled phase, the phases
+// being the ProfilePhase values
+#define ALLOCATION_OUTSIDE_PHASES NUMBER_PROFILE_PHASES
+
+class AllocationCounter
+{
+public:
+    // charges the allocations of the calling thread to phase, and returns the
+    // phase they were charged to before
+    static int enterPhase(int phase);
+    static void leavePhase(int previousPhase);
+
+    // since the start of the program
+    static long long getNumberAllocations();
+    static long long getNumberAllocations(int phase);
+    static long long getAllocatedBytes();
+
+    // allocated and not freed yet
+    static long long getLiveBytes();
+
+    // prints counts, the number of allocations of each phase
+    static void showAllocations(long long* counts);
+};
+
+#endif
+
+#endif
@@ -1,38 +1,67 @@
 #include "BatmanScene.h"
 #include "DrawingSettings.h"
+#include "SimulationSettings.h"
+#include "Profiler.h"
+#include "Tracer.h"
 
+#ifndef HEADLESS
 // OpenGL imports
 #include <GL/glut.h>
 #include <GL/gl.h>
 #include <GL/glu.h>
+#endif
+
+// tessellation of the spheres of the scene
+#define BATMAN_SCENE_SPHERE_SUBDIVISIONS 20
 
 BatmanScene::BatmanScene() :
     Scene(),
+    sphereBatch(BATMAN_SCENE_SPHERE_SUBDIVISIONS, BATMAN_SCENE_SPHERE_SUBDIVISIONS),
+    pi(3.141592)
+{
+    runningSceneEnabled = false;
+    // runningSceneEnabled = true;
+
+    if(runningSceneEnabled)
+    {
+        // cannot put more than 7 rigidity for cape
+        createScene(20, 2);
+    }
+    else
+    {
+        createScene(20, 1);
+    }
+}
+
+// scene with a cape of the given resolution, used when the scene is not run
+// interactively
+BatmanScene::BatmanScene(bool runningScene, int nodesWidth, int constraintInterleavingLevels) :
+    Scene(),
+    sphereBatch(BATMAN_SCENE_SPHERE_SUBDIVISIONS, BATMAN_SCENE_SPHERE_SUBDIVISIONS),
     pi(3.141592)
 {
-    createScene();
+    runningSceneEnabled = runningScene;
+    createScene(nodesWidth, constraintInterleavingLevels);
 }
 
-void BatmanScene::createScene()
+void BatmanScene::createScene(int nodesWidth, int constraintInterleavingLevels)
 {
+#ifndef HEADLESS
     GLfloat light_position[] = {0.0, 1.0, 1.0, 0.0};
     glLightfv(GL_LIGHT0, GL_POSITION, light_position);
-
-    runningSceneEnabled = false;
-    // runningSceneEnabled = true;
+#endif
 
     setupCamera();
 
     if(runningSceneEnabled)
     {
-        // cannot put more than 7 rigidity for cape
-        cape = new Cloth(10.0, 15.0, 20, 2);
+        cape = new Cloth(10.0, 15.0, nodesWidth, constraintInterleavingLevels);
         setClothMass(0.1);
         DrawingSettings::getInstance()->setOriginalTimeStep(0.001);
     }
     else
     {
-        cape = new Cloth(15.0, 15.0, 20, 1);
+        cape = new Cloth(15.0, 15.0, nodesWidth, constraintInterleavingLevels);
         setClothMass(1.0);
         DrawingSettings::getInstance()->setOriginalTimeStep(0.0001);
     }
@@ -51,6 +80,8 @@ void BatmanScene::createScene()
     addForces();
 
     time = 0.0;
+
+    updateRenderState(1.0);
 }
 
 void BatmanScene::createRunningScene()
@@ -143,28 +174,52 @@ void BatmanScene::createBoundaries()
             boundaries.push_back(Sphere(Vector3(xPos, yPos, -yPos) + Vector3(0.0, 0.0, 15), 0.5));
         }
     }
+
+    boundariesDepth = boundaries[0].getCenter().z - cape->getNode(0, cape->getNumberNodesHeight() - 1)->getPosition().z;
 }
 
+// moves the body along with the left shoulder, keeping the depth it had when
+// it was created
 void BatmanScene::translateBoundaries()
 {
     float leftShoulderZ = cape->getNode(0, cape->getNumberNodesHeight() - 1)->getPosition().z;
 
+    // computed once, as translating the first sphere changes its center
+    Vector3 offset(0.0, 0.0, leftShoulderZ + boundariesDepth - boundaries[0].getCenter().z);
+
     for(std::vector<Sphere>::iterator it = boundaries.begin();
         it != boundaries.end();
         ++it)
     {
-        it->translate(Vector3(0.0, 0.0, leftShoulderZ) - boundaries[0].getCenter());
+        it->translate(offset);
     }
 }
 
 void BatmanScene::simulate()
 {
+    TRACE_SCOPE("step");
+
     float timeStep = DrawingSettings::getInstance()->getTimeStep();
     if(timeStep != 0.0)
     {
         time += timeStep;
-        cape->applyForces(timeStep);
-        cape->satisfyConstraints();
+
+        {
+            PROFILE_SCOPE(PROFILE_APPLY_FORCES);
+            TRACE_SCOPE("apply forces");
+            cape->applyForces(timeStep);
+        }
+
+        {
+            PROFILE_SCOPE(PROFILE_SATISFY_CONSTRAINTS);
+            TRACE_SCOPE("satisfy constraints");
+
+            int iterations = SimulationSettings::getInstance()->getConstraintIterations();
+            for(int i = 0; i < iterations; i += 1)
+            {
+                cape->satisfyConstraints();
+            }
+        }
 
         if(runningSceneEnabled)
         {
@@ -173,58 +228,90 @@ void BatmanScene::simulate()
             swingRightFoot();
             swingRightShoulder();
 
+            PROFILE_SCOPE(PROFILE_SPHERE_INTERSECTIONS);
+            TRACE_SCOPE("sphere intersections");
             cape->handleSphereIntersections(&leftFoot);
             cape->handleSphereIntersections(&rightFoot);
 
-            // translateBoundaries();
-            // cape->handleSphereIntersections(&boundaries);
+            translateBoundaries();
+            cape->handleSphereIntersections(&boundaries);
         }
         else
         {
+            PROFILE_SCOPE(PROFILE_SPHERE_INTERSECTIONS);
+            TRACE_SCOPE("sphere intersections");
             cape->handleSphereIntersections(&otherSpheres);
         }
 
-        cape->handleSelfIntersections();
+        {
+            PROFILE_SCOPE(PROFILE_SELF_INTERSECTIONS);
+            TRACE_SCOPE("self intersections");
+            cape->handleSelfIntersections();
+        }
     }
 }
 
-void BatmanScene::drawFeet()
+void BatmanScene::draw(RenderPass* pass)
 {
-    drawBodyElement(&leftFoot);
-    drawBodyElement(&rightFoot);
+    drawWorldAxis(pass);
+    cape->draw(pass);
+
+    drawnSpheres.acquire();
+    drawBodyElement(pass, drawnSpheres.getReadBuffer());
 }
 
-void BatmanScene::drawOtherSpheres()
+Cloth* BatmanScene::getCape()
 {
-    drawBodyElement(&otherSpheres);
+    return cape;
 }
 
-void BatmanScene::draw()
+void BatmanScene::updateRenderState(float alpha)
 {
-    DrawingSettings::getInstance()->chooseRenderingMethod();
-    drawWorldAxis();
-    cape->draw();
+    cape->updateRenderState(alpha);
+
+    std::vector<Sphere>* spheres = drawnSpheres.getWriteBuffer();
+    spheres->clear();
 
     if(runningSceneEnabled)
     {
-        drawFeet();
-
-        // TODO : remove
-        // drawBodyElement(&boundaries);
+        spheres->insert(spheres->end(), leftFoot.begin(), leftFoot.end());
+        spheres->insert(spheres->end(), rightFoot.begin(), rightFoot.end());
     }
     else
     {
-        drawOtherSpheres();
+        spheres->insert(spheres->end(), otherSpheres.begin(), otherSpheres.end());
     }
+
+    drawnSpheres.publish();
 }
 
-void BatmanScene::drawBodyElement(std::vector<Sphere>* elements)
+void BatmanScene::showSimulationStatus()
 {
-    for(std::vector<Sphere>::iterator sphereIterator = elements->begin();
-        sphereIterator != elements->end();
-        ++sphereIterator)
+    cape->showCollisionStatus();
+}
+
+void BatmanScene::showMemoryStatus()
+{
+    cape->showMemoryStatus();
+}
+
+void BatmanScene::drawBodyElement(RenderPass* pass, std::vector<Sphere>* elements)
+{
+    DrawingSettings* drawingSettings = pass->getSettings();
+
+    if(drawingSettings->isDrawSpheresEnabled())
     {
-        sphereIterator->draw();
+        sphereBatch.clear();
+
+        for(std::vector<Sphere>::iterator sphereIterator = elements->begin();
+            sphereIterator != elements->end();
+            ++sphereIterator)
+        {
+            // draw the sphere a little smaller for collision problems
+            sphereBatch.addSphere(sphereIterator->getCenter(), sphereIterator->getRadius() - 0.2);
+        }
+
+        pass->addSpheres(&sphereBatch, drawingSettings->getSphereColor(), true);
     }
 }
 
@@ -5,6 +5,8 @@
 #include "Cloth.h"
 #include "Floor.h"
 #include "Sphere.h"
+#include "TripleBuffer.h"
+#include "SphereBatch.h"
 #include <vector>
 
 class BatmanScene : public Scene
@@ -18,14 +20,21 @@ private:
 
     std::vector<Sphere> boundaries;
 
+    // depth of the body relative to the left shoulder
+    float boundariesDepth;
+
     std::vector<Sphere> otherSpheres;
 
+    // spheres to draw, as they were when the cape frame was last published
+    TripleBuffer< std::vector<Sphere> > drawnSpheres;
+    SphereBatch sphereBatch;
+
     float pi;
 
     float time;
 
-    void createScene();
-    void drawBodyElement(std::vector<Sphere>* elements);
+    void createScene(int nodesWidth, int constraintInterleavingLevels);
+    void drawBodyElement(RenderPass* pass, std::vector<Sphere>* elements);
 
     void swingLeftFoot();
     void swingRightFoot();
@@ -43,8 +52,6 @@ private:
     void setupCamera();
     void setupFeet();
 
-    void drawFeet();
-    void drawOtherSpheres();
     void addForces();
     void createCenterCollisionBallScene();
     void createRunningScene();
@@ -53,8 +60,14 @@ private:
 
 public:
     BatmanScene();
-    void draw();
+    BatmanScene(bool runningScene, int nodesWidth, int constraintInterleavingLevels);
+    void draw(RenderPass* pass);
     void simulate();
+    void updateRenderState(float alpha);
+    void showSimulationStatus();
+    void showMemoryStatus();
+
+    Cloth* getCape();
 };
 
 #endif
\ No newline at end of file
@@ -1,66 +1,553 @@
-// OpenGL imports
-#include <GL/glut.h>
-#include <GL/gl.h>
-#include <GL/glu.h>
-
 #include "Cloth.h"
 #include "DrawingSettings.h"
+#include "SimulationSettings.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+
+// radius and tessellation of the spheres drawn on the nodes and at the tip of
+// arrows
+#define CLOTH_MARKER_RADIUS 0.1
+#define CLOTH_MARKER_SUBDIVISIONS 6
 
 Cloth::Cloth(float clothTotalWidth, float clothTotalHeight, int nodesWidth, int constraintInterleavingLevels) :
     clothWidth(clothTotalWidth),
     clothHeight(clothTotalHeight),
     numberNodesWidth(nodesWidth),
     numberNodesHeight(clothTotalHeight / (clothTotalWidth / nodesWidth)),
-    interleaving(constraintInterleavingLevels)
+    interleaving(constraintInterleavingLevels),
+    nodeMarkers(CLOTH_MARKER_SUBDIVISIONS, CLOTH_MARKER_SUBDIVISIONS),
+    arrowTips(CLOTH_MARKER_SUBDIVISIONS, CLOTH_MARKER_SUBDIVISIONS),
+    coloredSolver(0),
+    numberSphereContacts(0),
+    step(0),
+    contactStep(-1),
+    triangleBvhAge(0),
+    numberTriangleBvhBuilds(0),
+    numberTriangleContacts(0)
 {
     createNodes();
     createConstraints();
     createTriangles();
+    createFrames();
+    reserveStepBuffers();
 }
 
+// Contacts are found first, and only the nodes in contact are then changed,
+// so a node touching several spheres keeps the tangent part of its force with
+// respect to all of them. The forces of the nodes which were in contact at
+// the previous step are put back to their original value before the first
+// set of spheres of a step is handled.
 void Cloth::handleSphereIntersections(std::vector<Sphere>* spheres)
 {
-    for(std::vector<Sphere>::iterator sphereIterator = spheres->begin();
-        sphereIterator != spheres->end();
-        ++sphereIterator)
+    if(contactStep != step)
+    {
+        releaseContacts();
+        contactStep = step;
+    }
+
+    SphereGrid* grid = 0;
+
+    if(spheres->size() >= SPHERE_GRID_MINIMUM_SPHERES)
+    {
+        grid = &sphereGrids[spheres];
+        grid->update(spheres);
+    }
+
+    contacts.clear();
+    sphereCollider->generateContacts(spheres, grid, &contacts);
+    respondToContacts();
+}
+
+// pushes the nodes in contact back onto the surface of the colliders, and only
+// keeps the tangent part of their force, since the normal force is absorbed by
+// the colliders
+void Cloth::respondToContacts()
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+    double* forceX = particles->forceX;
+    double* forceY = particles->forceY;
+    double* forceZ = particles->forceZ;
+    unsigned char* contact = particles->contact;
+
+    for(std::vector<Contact>::iterator it = contacts.begin();
+        it != contacts.end();
+        ++it)
     {
-        for(int x = 0; x < numberNodesWidth; x += 1)
+        int i = it->node;
+
+        positionX[i] += it->normalX * it->depth;
+        positionY[i] += it->normalY * it->depth;
+        positionZ[i] += it->normalZ * it->depth;
+
+        double normalForce = forceX[i] * it->normalX + forceY[i] * it->normalY + forceZ[i] * it->normalZ;
+        forceX[i] -= normalForce * it->normalX;
+        forceY[i] -= normalForce * it->normalY;
+        forceZ[i] -= normalForce * it->normalZ;
+
+        if(!contact[i])
         {
-            for(int y = 0; y < numberNodesHeight; y += 1)
-            {
-                // this is not a self-intersection test
-                sphereIterator->handleNodeIntersection(getNode(x, y), false);
-            }
+            contact[i] = 1;
+            contactedNodes.push_back(i);
         }
     }
+
+    numberSphereContacts += contacts.size();
+}
+
+// no longer in collision with the spheres, so put the original force back
+void Cloth::releaseContacts()
+{
+    for(std::vector<int>::iterator it = contactedNodes.begin();
+        it != contactedNodes.end();
+        ++it)
+    {
+        particles->resetToOriginalForce(*it);
+        particles->contact[*it] = 0;
+    }
+
+    contactedNodes.clear();
+    numberSphereContacts = 0;
 }
 
 void Cloth::handleSelfIntersections()
 {
-    for(int x1 = 0; x1 < numberNodesWidth; x1 += 1)
+    switch(SimulationSettings::getInstance()->getSelfCollisionMode())
+    {
+        case SPATIAL_HASH_SELF_COLLISION:
+            handleSelfIntersectionsSpatialHash();
+            break;
+        case NEIGHBOR_LIST_SELF_COLLISION:
+            handleSelfIntersectionsNeighborList();
+            break;
+        default:
+            handleSelfIntersectionsBruteForce();
+            break;
+    }
+
+    if(SimulationSettings::getInstance()->isTriangleSelfCollisionEnabled())
+    {
+        handleTriangleSelfIntersections();
+    }
+}
+
+void Cloth::handleSelfIntersectionsBruteForce()
+{
+    int numberParticles = particles->getNumberParticles();
+    bool skipNeighbors = SimulationSettings::getInstance()->isSkipTopologicalNeighborsEnabled();
+
+    for(int i = 0; i < numberParticles; i += 1)
     {
-        for(int y1 = 0; y1 < numberNodesHeight; y1 += 1)
+        for(int j = 0; j < numberParticles; j += 1)
         {
-            Node* node1 = getNode(x1, y1);
+            // we should not test if 2 identical nodes touch each other,
+            // otherwise the cloth would deform forever, as 2 identical
+            // nodes are exactly on one another, and will try to continuously
+            // repel themselves
+            if(i != j && !(skipNeighbors && areTopologicalNeighbors(i, j)))
+            {
+                pushOutOfBoundary(i, j);
+            }
+        }
+    }
+}
+
+// Gives exactly the same result as the brute force version. For a given node
+// i, each push only depends on the position of node i (which does not move
+// while i is handled) and on the position of the pushed node, so the order in
+// which the nodes close to i are visited does not matter. The grid is only
+// updated once all the nodes close to i have been handled, so that a node
+// pushed into a bucket which has not been visited yet is not tested twice.
+void Cloth::handleSelfIntersectionsSpatialHash()
+{
+    int numberParticles = particles->getNumberParticles();
+    bool skipNeighbors = SimulationSettings::getInstance()->isSkipTopologicalNeighborsEnabled();
+
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
 
-            for(int x2 = 0; x2 < numberNodesWidth; x2 += 1)
+    // a node closer than the boundary radius is at most one cell away
+    selfIntersectionGrid.build(particles, particles->getBoundaryRadius());
+    pushedNodes.reserve(numberParticles);
+
+    int buckets[27];
+
+    for(int i = 0; i < numberParticles; i += 1)
+    {
+        int numberBuckets = selfIntersectionGrid.getNeighborBuckets(positionX[i], positionY[i], positionZ[i], buckets);
+
+        for(int b = 0; b < numberBuckets; b += 1)
+        {
+            for(int j = selfIntersectionGrid.getFirstNode(buckets[b]);
+                j != -1;
+                j = selfIntersectionGrid.getNextNode(j))
             {
-                for(int y2 = 0; y2 < numberNodesHeight; y2 += 1)
+                if(i != j && !(skipNeighbors && areTopologicalNeighbors(i, j)))
                 {
-                    // we should not test if 2 identical nodes touch each other,
-                    // otherwise the cloth would deform forever, as 2 identical
-                    // nodes are exactly on one another, and will try to continuously
-                    // repel themselves
-                    if(x1 != x2 || y1 != y2)
+                    if(pushOutOfBoundary(i, j))
                     {
-                        Node* node2 = getNode(x2, y2);
+                        pushedNodes.push_back(j);
+                    }
+                }
+            }
+        }
+
+        for(std::vector<int>::iterator it = pushedNodes.begin();
+            it != pushedNodes.end();
+            ++it)
+        {
+            selfIntersectionGrid.updateNode(*it, positionX[*it], positionY[*it], positionZ[*it]);
+        }
+
+        pushedNodes.clear();
+    }
+}
+
+// Same pushes as the spatial hash version, but the candidates of each node are
+// reused from step to step. While no node has moved more than half the skin
+// since the list was built, two nodes closer than the boundary radius were
+// closer than radius + skin at build time, so they are in the list. Nodes
+// pushed during the pass are checked too: if one of them went too far, the
+// list is rebuilt at the next step.
+void Cloth::handleSelfIntersectionsNeighborList()
+{
+    SimulationSettings* settings = SimulationSettings::getInstance();
+
+    int numberParticles = particles->getNumberParticles();
+    bool skipNeighbors = settings->isSkipTopologicalNeighborsEnabled();
+    double radius = particles->getBoundaryRadius();
+    double skin = radius * settings->getNeighborListSkin();
+
+    if(selfIntersectionNeighbors.needsRebuild(particles, radius, skin, skipNeighbors))
+    {
+        buildSelfIntersectionNeighbors(radius, skin, skipNeighbors);
+    }
+
+    for(int i = 0; i < numberParticles; i += 1)
+    {
+        int end = selfIntersectionNeighbors.getNeighborsEnd(i);
+
+        for(int k = selfIntersectionNeighbors.getNeighborsBegin(i); k < end; k += 1)
+        {
+            int j = selfIntersectionNeighbors.getNeighbor(k);
+
+            if(pushOutOfBoundary(i, j))
+            {
+                selfIntersectionNeighbors.checkDisplacement(particles, j);
+            }
+        }
+    }
+
+    selfIntersectionNeighbors.countUpdate();
+}
+
+void Cloth::buildSelfIntersectionNeighbors(double radius, double skin, bool skipNeighbors)
+{
+    int numberParticles = particles->getNumberParticles();
+
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    double searchRadius = radius + skin;
+    double searchRadiusSquared = searchRadius * searchRadius;
+
+    // a node closer than the search radius is at most one cell away
+    selfIntersectionGrid.build(particles, searchRadius);
+    selfIntersectionNeighbors.beginBuild(particles, radius, skin, skipNeighbors);
+
+    int buckets[27];
+
+    for(int i = 0; i < numberParticles; i += 1)
+    {
+        int numberBuckets = selfIntersectionGrid.getNeighborBuckets(positionX[i], positionY[i], positionZ[i], buckets);
 
-                        node1->handleNodeIntersection(node2);
+        for(int b = 0; b < numberBuckets; b += 1)
+        {
+            for(int j = selfIntersectionGrid.getFirstNode(buckets[b]);
+                j != -1;
+                j = selfIntersectionGrid.getNextNode(j))
+            {
+                if(i != j && !(skipNeighbors && areTopologicalNeighbors(i, j)))
+                {
+                    double dx = positionX[j] - positionX[i];
+                    double dy = positionY[j] - positionY[i];
+                    double dz = positionZ[j] - positionZ[i];
+
+                    if(dx * dx + dy * dy + dz * dz < searchRadiusSquared)
+                    {
+                        selfIntersectionNeighbors.addNeighbor(j);
                     }
                 }
             }
         }
+
+        selfIntersectionNeighbors.endNode();
+    }
+}
+
+// The memory of everything sized by the number of nodes (the particles, their
+// Node views, the 3 drawn frames, the triangles, the contact buffers and the
+// self collision broadphases), of the constraint table and of the copy sorted
+// by the colored solver, and of the sphere grids, which grow with the spheres.
+// The broadphases are only allocated once used, so the figures grow as the
+// settings are changed
+void Cloth::showMemoryStatus()
+{
+    int numberParticles = particles->getNumberParticles();
+
+    long long nodeBytes = particles->getMemorySize() +
+                          nodes.capacity() * sizeof(Node) +
+                          triangleIndices.capacity() * sizeof(int) +
+                          contacts.capacity() * sizeof(Contact) +
+                          contactedNodes.capacity() * sizeof(int) +
+                          sphereCollider->getMemorySize() +
+                          selfIntersectionGrid.getMemorySize() +
+                          pushedNodes.capacity() * sizeof(int) +
+                          selfIntersectionNeighbors.getMemorySize() +
+                          triangleBvh.getMemorySize() +
+                          candidateTriangles.capacity() * sizeof(int);
+
+    for(int i = 0; i < 3; i += 1)
+    {
+        nodeBytes += frames.getSlot(i)->getMemorySize();
+    }
+
+    long long constraintBytes = constraints.capacity() * sizeof(Constraint);
+    if(coloredSolver != 0)
+    {
+        constraintBytes += coloredSolver->getMemorySize();
+    }
+
+    long long sphereBytes = 0;
+    for(std::map<std::vector<Sphere>*, SphereGrid>::iterator it = sphereGrids.begin();
+        it != sphereGrids.end();
+        ++it)
+    {
+        sphereBytes += it->second.getMemorySize();
+    }
+
+    std::cout << "memory status:" << std::endl;
+    std::cout << "  bytes per node                  : " << (double) nodeBytes / numberParticles << std::endl;
+    std::cout << "  bytes per constraint            : " << (double) constraintBytes / constraints.size() << std::endl;
+    std::cout << "  sphere grids                    : " << sphereBytes / 1024 << " KiB" << std::endl;
+    std::cout << "  total                           : " << (nodeBytes + constraintBytes + sphereBytes) / 1024 << " KiB" << std::endl;
+    std::cout << std::endl;
+}
+
+void Cloth::showCollisionStatus()
+{
+    std::cout << "sphere contacts at last step     : " << numberSphereContacts << std::endl;
+    std::cout << "sphere grids:" << std::endl;
+
+    for(std::map<std::vector<Sphere>*, SphereGrid>::iterator it = sphereGrids.begin();
+        it != sphereGrids.end();
+        ++it)
+    {
+        std::cout << "  " << it->first->size() << " spheres, built " << it->second.getNumberBuilds() << " times" << std::endl;
+    }
+
+    int numberBuilds = selfIntersectionNeighbors.getNumberBuilds();
+    int numberUpdates = selfIntersectionNeighbors.getNumberUpdates();
+
+    std::cout << "self-intersection neighbor list:" << std::endl;
+    std::cout << "  steps                           : " << numberUpdates << std::endl;
+    std::cout << "  rebuilds                        : " << numberBuilds << std::endl;
+
+    if(numberBuilds > 0)
+    {
+        std::cout << "  steps per rebuild               : " << (double) numberUpdates / numberBuilds << std::endl;
+        std::cout << "  candidates per node             : " << (double) selfIntersectionNeighbors.getNumberPairs() / particles->getNumberParticles() << std::endl;
+    }
+
+    std::cout << "self-intersection triangles:" << std::endl;
+    std::cout << "  bvh nodes                       : " << triangleBvh.getNumberNodes() << std::endl;
+    std::cout << "  bvh rebuilds                    : " << numberTriangleBvhBuilds << std::endl;
+    std::cout << "  contacts at last step           : " << numberTriangleContacts << std::endl;
+
+    std::cout << std::endl;
+}
+
+// Keeps the nodes on the side of the triangles they were on at the previous
+// step. The hierarchy is refit to the nodes at every step, and only rebuilt
+// every few steps. Each node is tested against the triangles whose box
+// overlaps the path of the node during the step, so a node which went
+// through a triangle during the step is found as well.
+void Cloth::handleTriangleSelfIntersections()
+{
+    SimulationSettings* settings = SimulationSettings::getInstance();
+
+    int numberParticles = particles->getNumberParticles();
+    double thickness = particles->getBoundaryRadius() * settings->getTriangleCollisionThickness();
+
+    if(triangleBvh.getNumberNodes() == 0 ||
+       triangleBvh.getMargin() != thickness ||
+       triangleBvhAge >= settings->getTriangleBvhRebuildInterval())
+    {
+        triangleBvh.build(particles, &triangleIndices, thickness);
+        triangleBvhAge = 0;
+        numberTriangleBvhBuilds += 1;
+    }
+    else
+    {
+        triangleBvh.refit(particles);
+    }
+
+    triangleBvhAge += 1;
+    numberTriangleContacts = 0;
+
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+    double* oldPositionX = particles->oldPositionX;
+    double* oldPositionY = particles->oldPositionY;
+    double* oldPositionZ = particles->oldPositionZ;
+
+    for(int i = 0; i < numberParticles; i += 1)
+    {
+        candidateTriangles.clear();
+        triangleBvh.query(std::min(positionX[i], oldPositionX[i]),
+                          std::min(positionY[i], oldPositionY[i]),
+                          std::min(positionZ[i], oldPositionZ[i]),
+                          std::max(positionX[i], oldPositionX[i]),
+                          std::max(positionY[i], oldPositionY[i]),
+                          std::max(positionZ[i], oldPositionZ[i]),
+                          &candidateTriangles);
+
+        for(std::vector<int>::iterator it = candidateTriangles.begin();
+            it != candidateTriangles.end();
+            ++it)
+        {
+            if(pushOutOfTriangle(i, *it, thickness))
+            {
+                numberTriangleContacts += 1;
+            }
+        }
+    }
+}
+
+// pushes node out of the slab of the given thickness around triangle, back to
+// the side it was on at the previous step. The correction is shared between
+// the node and the corners of the triangle, depending on where the node is
+// above the triangle and on which of them can move. Returns true if there was
+// a correction
+bool Cloth::pushOutOfTriangle(int node, int triangle, double thickness)
+{
+    int n1 = triangleIndices[3 * triangle];
+    int n2 = triangleIndices[3 * triangle + 1];
+    int n3 = triangleIndices[3 * triangle + 2];
+
+    // the triangles around a node always touch it, and the ones right next to
+    // them are kept at a distance by the constraints
+    if(areTopologicalNeighbors(node, n1) ||
+       areTopologicalNeighbors(node, n2) ||
+       areTopologicalNeighbors(node, n3))
+    {
+        return false;
+    }
+
+    Vector3 normal;
+    double distance;
+    Vector3 barycentric;
+
+    if(!Triangle::projectPoint(particles->getPosition(node),
+                               particles->getPosition(n1),
+                               particles->getPosition(n2),
+                               particles->getPosition(n3),
+                               &normal,
+                               &distance,
+                               &barycentric))
+    {
+        return false;
+    }
+
+    // 5) side of the triangle the node was on at the previous step, measured
+    // along the same normal as the current distance. A triangle which flipped
+    // during the step would otherwise push a node which stayed on its side
+    // through it
+    Vector3 oldP1 = particles->getOldPosition(n1);
+    double side = (particles->getOldPosition(node) - oldP1).dot(normal);
+
+    if(side == 0.0)
+    {
+        side = distance;
+    }
+
+    double target = side < 0.0 ? -thickness : thickness;
+
+    if(fabs(distance) >= thickness && (distance < 0.0) == (target < 0.0))
+    {
+        return false;
+    }
+
+    // at most one thickness per step, so a node which crossed far through the
+    // triangle is brought back over several steps instead of being thrown
+    double push = target - distance;
+    push = std::max(-thickness, std::min(thickness, push));
+
+    double* mobility = particles->mobility;
+    double weight = mobility[node] +
+                    barycentric.x * barycentric.x * mobility[n1] +
+                    barycentric.y * barycentric.y * mobility[n2] +
+                    barycentric.z * barycentric.z * mobility[n3];
+
+    if(weight == 0.0)
+    {
+        return false;
+    }
+
+    Vector3 correction = normal * (push / weight);
+
+    particles->setPosition(node, particles->getPosition(node) + correction * mobility[node]);
+    particles->setPosition(n1, particles->getPosition(n1) - correction * (barycentric.x * mobility[n1]));
+    particles->setPosition(n2, particles->getPosition(n2) - correction * (barycentric.y * mobility[n2]));
+    particles->setPosition(n3, particles->getPosition(n3) - correction * (barycentric.z * mobility[n3]));
+
+    return true;
+}
+
+// nodes which are at most one step away from each other in the cloth grid
+bool Cloth::areTopologicalNeighbors(int node1, int node2)
+{
+    int x1 = node1 / numberNodesHeight;
+    int y1 = node1 % numberNodesHeight;
+    int x2 = node2 / numberNodesHeight;
+    int y2 = node2 % numberNodesHeight;
+
+    return abs(x1 - x2) <= 1 && abs(y1 - y2) <= 1;
+}
+
+// pushes node back onto the boundary sphere of center if it is inside it, and
+// returns true if it was
+bool Cloth::pushOutOfBoundary(int center, int node)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    double radius = particles->getBoundaryRadius();
+
+    double toNodeX = positionX[node] - positionX[center];
+    double toNodeY = positionY[node] - positionY[center];
+    double toNodeZ = positionZ[node] - positionZ[center];
+    double length = sqrt(toNodeX * toNodeX + toNodeY * toNodeY + toNodeZ * toNodeZ);
+
+    if(length < radius)
+    {
+        double push = (radius - length) / length;
+        positionX[node] += toNodeX * push;
+        positionY[node] += toNodeY * push;
+        positionZ[node] += toNodeZ * push;
+
+        return true;
     }
+
+    return false;
 }
 
 float Cloth::getClothWidth()
@@ -75,7 +562,17 @@ float Cloth::getClothHeight()
 
 Node* Cloth::getNode(int x, int y)
 {
-    return &nodes[x][y];
+    return &nodes[getNodeIndex(x, y)];
+}
+
+int Cloth::getNodeIndex(int x, int y)
+{
+    return x * numberNodesHeight + y;
+}
+
+ParticleStore* Cloth::getParticles()
+{
+    return particles;
 }
 
 int Cloth::getNumberNodesWidth()
@@ -88,176 +585,111 @@ int Cloth::getNumberNodesHeight()
     return numberNodesHeight;
 }
 
+int Cloth::getNumberConstraints()
+{
+    return constraints.size();
+}
+
+int Cloth::getNumberTriangleContacts()
+{
+    return numberTriangleContacts;
+}
+
 void Cloth::createNodes()
 {
     float spacing = clothWidth / numberNodesWidth;
 
+    particles = new ParticleStore(numberNodesWidth * numberNodesHeight, spacing / 1.125);
+    integrator = new VerletIntegrator(particles);
+    sphereCollider = new SphereCollider(particles);
+    nodes.reserve(numberNodesWidth * numberNodesHeight);
+
     for(int x = 0; x < numberNodesWidth; x += 1)
     {
         float xPos = x * spacing;
 
-        std::vector<Node> nodeColumn;
-
         for(int y = 0; y < numberNodesHeight; y += 1)
         {
             float yPos = y * spacing;
+            int index = getNodeIndex(x, y);
 
             // put elements in rectangular grid with 0.0 depth
-            nodeColumn.push_back(Node(Vector3(xPos, yPos, 0.0), spacing / 1.125));
-        }
+            particles->setPosition(index, Vector3(xPos, yPos, 0.0));
+            particles->setOldPosition(index, Vector3(xPos, yPos, 0.0));
 
-        nodes.push_back(nodeColumn);
+            nodes.push_back(Node(particles, index));
+        }
     }
 }
 
-void Cloth::updateTriangles()
+void Cloth::createTriangles()
 {
     for(int x = 0; x < numberNodesWidth - 1; x += 1)
     {
         for(int y = 0; y < numberNodesHeight - 1; y += 1)
         {
-            Node* bottomLeft = getNode(x, y);
-            Node* bottomRight = getNode(x + 1, y);
-            Node* topLeft = getNode(x, y + 1);
-            Node* topRight = getNode(x + 1, y + 1);
-
-            Triangle lowerTriangle(topLeft, bottomLeft, bottomRight);
-            Triangle upperTriangle(topLeft, bottomRight, topRight);
-
-            triangles[x][y][0] = lowerTriangle;
-            triangles[x][y][1] = upperTriangle;
+            // lower triangle
+            triangleIndices.push_back(getNodeIndex(x, y + 1));
+            triangleIndices.push_back(getNodeIndex(x, y));
+            triangleIndices.push_back(getNodeIndex(x + 1, y));
+
+            // upper triangle
+            triangleIndices.push_back(getNodeIndex(x, y + 1));
+            triangleIndices.push_back(getNodeIndex(x + 1, y));
+            triangleIndices.push_back(getNodeIndex(x + 1, y + 1));
         }
     }
 }
 
-void Cloth::updateNodeNormals()
+// every slot of the triple buffer starts with the initial state of the
+// cloth, so there is always a complete frame to draw
+void Cloth::createFrames()
 {
-    for(int x = 0; x < numberNodesWidth; x += 1)
+    for(int i = 0; i < 3; i += 1)
     {
-        for(int y = 0; y < numberNodesHeight; y += 1)
-        {
-            Node* currentNode = getNode(x, y);
-            Vector3 currentNormal;
-
-            std::vector<Triangle*> adjacentTriangles;
-
-            if(x == 0 && y == 0)
-            {
-                adjacentTriangles.push_back(&triangles[x][y][0]);
-            }
-            else if(x == 0 && y == numberNodesHeight - 1)
-            {
-                adjacentTriangles.push_back(&triangles[x][y - 1][0]);
-                adjacentTriangles.push_back(&triangles[x][y - 1][1]);
-            }
-            else if(x == numberNodesWidth - 1 && y == 0)
-            {
-                adjacentTriangles.push_back(&triangles[x - 1][y][0]);
-                adjacentTriangles.push_back(&triangles[x - 1][y][1]);
-            }
-            else if(x == numberNodesWidth - 1 && y == numberNodesHeight - 1)
-            {
-                adjacentTriangles.push_back(&triangles[x - 1][y - 1][1]);
-            }
-            else if(x == 0)
-            {
-                adjacentTriangles.push_back(&triangles[x][y - 1][0]);
-                adjacentTriangles.push_back(&triangles[x][y - 1][1]);
-                adjacentTriangles.push_back(&triangles[x][y    ][0]);
-            }
-            else if(x == numberNodesWidth - 1)
-            {
-                adjacentTriangles.push_back(&triangles[x - 1][y - 1][1]);
-                adjacentTriangles.push_back(&triangles[x - 1][y    ][0]);
-                adjacentTriangles.push_back(&triangles[x - 1][y - 1][1]);
-            }
-            else if(y == 0)
-            {
-                adjacentTriangles.push_back(&triangles[x - 1][y][0]);
-                adjacentTriangles.push_back(&triangles[x - 1][y][1]);
-                adjacentTriangles.push_back(&triangles[x    ][y][0]);
-            }
-            else if(y == numberNodesHeight - 1)
-            {
-                adjacentTriangles.push_back(&triangles[x - 1][y - 1][1]);
-                adjacentTriangles.push_back(&triangles[x    ][y - 1][0]);
-                adjacentTriangles.push_back(&triangles[x    ][y - 1][1]);
-            }
-            else if(0 < x                      &&
-                    x < numberNodesWidth - 1   &&
-                    0 < y                      &&
-                    y < numberNodesHeight - 1)
-            {
-                adjacentTriangles.push_back(&triangles[x - 1][y - 1][1]);
-                adjacentTriangles.push_back(&triangles[x    ][y - 1][0]);
-                adjacentTriangles.push_back(&triangles[x    ][y - 1][1]);
-                adjacentTriangles.push_back(&triangles[x    ][y    ][0]);
-                adjacentTriangles.push_back(&triangles[x - 1][y    ][1]);
-                adjacentTriangles.push_back(&triangles[x - 1][y    ][0]);
-            }
-
-            // sum the normals of each adjacent triangle to get the current node's
-            // normal value
-            for(std::vector<Triangle*>::iterator it = adjacentTriangles.begin();
-                it != adjacentTriangles.end();
-                ++it)
-            {
-                currentNormal += (*it)->getNormal();
-            }
-
-            currentNormal = currentNormal.normalize();
-            currentNode->setNormal(currentNormal);
-        }
+        frames.getSlot(i)->create(numberNodesWidth, numberNodesHeight, particles);
     }
+
+    mesh = new ClothMesh(&triangleIndices, numberNodesWidth * numberNodesHeight);
 }
 
-void Cloth::createTriangles()
+// moves the nodes depending on the forces that are being applied to them
+void Cloth::applyForces(float duration)
 {
-    for(int x = 0; x < numberNodesWidth - 1; x += 1)
-    {
-        std::vector< std::vector<Triangle> > triangleColumn;
-
-        for(int y = 0; y < numberNodesHeight - 1; y += 1)
-        {
-            Node* bottomLeft = getNode(x, y);
-            Node* bottomRight = getNode(x + 1, y);
-            Node* topLeft = getNode(x, y + 1);
-            Node* topRight = getNode(x + 1, y + 1);
-
-            Triangle lowerTriangle(topLeft, bottomLeft, bottomRight);
-            Triangle upperTriangle(topLeft, bottomRight, topRight);
+    integrator->integrate(duration);
+    step += 1;
+}
 
-            std::vector<Triangle> triangleSquare;
-            triangleSquare.push_back(lowerTriangle);
-            triangleSquare.push_back(upperTriangle);
+// adds a force to every node. This also becomes the force the nodes go back to
+// when they leave a collider.
+void Cloth::addForce(Vector3 force)
+{
+    int numberParticles = particles->getNumberParticles();
 
-            triangleColumn.push_back(triangleSquare);
-        }
+    double* forceX = particles->forceX;
+    double* forceY = particles->forceY;
+    double* forceZ = particles->forceZ;
+    double* originalForceX = particles->originalForceX;
+    double* originalForceY = particles->originalForceY;
+    double* originalForceZ = particles->originalForceZ;
 
-        triangles.push_back(triangleColumn);
+    // one pass per array, which the compiler vectorizes
+    for(int i = 0; i < numberParticles; i += 1)
+    {
+        forceX[i] += force.x;
+        originalForceX[i] = forceX[i];
     }
-}
 
-// moves the nodes depending on the forces that are being applied to them
-void Cloth::applyForces(float duration)
-{
-    for(int x = 0; x < numberNodesWidth; x += 1)
+    for(int i = 0; i < numberParticles; i += 1)
     {
-        for(int y = 0; y < numberNodesHeight; y += 1)
-        {
-            getNode(x, y)->applyForces(duration);
-        }
+        forceY[i] += force.y;
+        originalForceY[i] = forceY[i];
     }
-}
 
-void Cloth::addForce(Vector3 force)
-{
-    for(int x = 0; x < numberNodesWidth; x += 1)
+    for(int i = 0; i < numberParticles; i += 1)
     {
-        for(int y = 0; y < numberNodesHeight; y += 1)
-        {
-            getNode(x, y)->addForce(force);
-        }
+        forceZ[i] += force.z;
+        originalForceZ[i] = forceZ[i];
     }
 }
 
@@ -269,208 +701,281 @@ void Cloth::createConstraints()
 
 void Cloth::createStructuralConstraints()
 {
+    std::vector<Constraint> rightConstraints;
+    std::vector<Constraint> topConstraints;
+
     for(int i = 1; i <= interleaving; i += 1)
     {
-        createInterleavedStructuralConstraints(i);
+        createInterleavedStructuralConstraints(i, &rightConstraints, &topConstraints);
     }
 
-    structuralConstraints.push_back(&rightStructuralConstraints);
-    structuralConstraints.push_back(&topStructuralConstraints);
+    constraints.insert(constraints.end(), rightConstraints.begin(), rightConstraints.end());
+    constraints.insert(constraints.end(), topConstraints.begin(), topConstraints.end());
+
+    numberStructuralConstraints = constraints.size();
 }
 
 void Cloth::createShearConstraints()
 {
+    std::vector<Constraint> upperRightConstraints;
+    std::vector<Constraint> lowerRightConstraints;
+
     for(int i = 1; i <= interleaving; i += 1)
     {
-        createInterleavedShearConstraints(i);
+        createInterleavedShearConstraints(i, &upperRightConstraints, &lowerRightConstraints);
     }
 
-    shearConstraints.push_back(&upperRightShearConstraints);
-    shearConstraints.push_back(&lowerRightShearConstraints);
+    constraints.insert(constraints.end(), upperRightConstraints.begin(), upperRightConstraints.end());
+    constraints.insert(constraints.end(), lowerRightConstraints.begin(), lowerRightConstraints.end());
 }
 
-void Cloth::draw()
+// the buffers filled during a step are sized up front for the most entries
+// they can get in practice (a few contacts per node), so a step does not
+// allocate once the cloth is created
+void Cloth::reserveStepBuffers()
 {
-    drawNodes();
-    drawConstraints();
-    drawShaded();
+    int numberParticles = particles->getNumberParticles();
+
+    contacts.reserve(numberParticles * CONTACTS_PER_NODE);
+    contactedNodes.reserve(numberParticles);
+    candidateTriangles.reserve(triangleIndices.size() / 3);
 }
 
-void Cloth::drawNodes()
+void Cloth::updateRenderState(float alpha)
 {
-    // loop over vertices (not edges)
-    for(int x = 0; x < numberNodesWidth; x += 1)
+    TRACE_SCOPE("update render state");
+
+    frames.getWriteBuffer()->update(particles, alpha);
+    frames.publish();
+}
+
+void Cloth::draw(RenderPass* pass)
+{
+    PROFILE_SCOPE(PROFILE_CLOTH_DRAW);
+    TRACE_SCOPE("cloth draw");
+
+    frames.acquire();
+    ClothFrame* frame = frames.getReadBuffer();
+
+    // the arrows of the nodes and triangles are gathered while they are
+    // submitted, and submitted together at the end
+    arrowLines.clear();
+    arrowTips.clear();
+
+    drawNodes(pass, frame);
+    drawConstraints(pass, frame);
+    drawShaded(pass, frame);
+    drawArrows(pass);
+}
+
+// submits a marker on each node, and gathers the arrows of the forces applied
+// to them
+void Cloth::drawNodes(RenderPass* pass, ClothFrame* frame)
+{
+    DrawingSettings* drawingSettings = pass->getSettings();
+
+    if(drawingSettings->isDrawNodesEnabled())
     {
-        for(int y = 0; y < numberNodesHeight; y += 1)
+        ParticleStore* drawn = frame->getParticles();
+        int count = drawn->getNumberParticles();
+
+        nodeMarkers.clear();
+        for(int i = 0; i < count; i += 1)
+        {
+            nodeMarkers.addSphere(drawn->getPosition(i), CLOTH_MARKER_RADIUS);
+        }
+
+        pass->addSpheres(&nodeMarkers, drawingSettings->getNodesColor(), false);
+
+        if(drawingSettings->isDrawArrowsEnabled())
         {
-            getNode(x, y)->draw();
+            for(int i = 0; i < count; i += 1)
+            {
+                Vector3 position = drawn->getPosition(i);
+                addArrow(position, position + drawn->getForce(i));
+            }
         }
     }
 }
 
-void Cloth::drawShaded()
+void Cloth::drawShaded(RenderPass* pass, ClothFrame* frame)
 {
-    updateTriangles();
-    updateNodeNormals();
+    DrawingSettings* drawingSettings = pass->getSettings();
 
-    for(int x = 0; x < numberNodesWidth - 1; x += 1)
+    if(drawingSettings->isDrawTrianglesEnabled())
     {
-        for(int y = 0; y < numberNodesHeight - 1; y += 1)
+        mesh->upload(frame);
+        pass->addMesh(mesh, drawingSettings->getTriangleColor());
+
+        if(drawingSettings->isDrawArrowsEnabled())
         {
-            triangles[x][y][0].draw();
-            triangles[x][y][1].draw();
+            addFaceNormalArrows(frame);
+        }
+    }
+}
+
+void Cloth::addArrow(Vector3 base, Vector3 end)
+{
+    arrowLines.addLine(base, end);
+    arrowTips.addSphere(end, CLOTH_MARKER_RADIUS);
+}
+
+void Cloth::drawArrows(RenderPass* pass)
+{
+    DrawingSettings* drawingSettings = pass->getSettings();
+
+    if(drawingSettings->isDrawArrowsEnabled())
+    {
+        pass->addLines(&arrowLines, drawingSettings->getArrowColor());
+        pass->addSpheres(&arrowTips, drawingSettings->getArrowColor(), false);
+    }
+}
+
+// gathers the unit normal of each triangle, from its center
+void Cloth::addFaceNormalArrows(ClothFrame* frame)
+{
+    ParticleStore* drawn = frame->getParticles();
+
+    for(unsigned int i = 0; i < triangleIndices.size(); i += 3)
+    {
+        Vector3 p1 = drawn->getPosition(triangleIndices[i]);
+        Vector3 p2 = drawn->getPosition(triangleIndices[i + 1]);
+        Vector3 p3 = drawn->getPosition(triangleIndices[i + 2]);
+
+        Vector3 normal = (p2 - p1).cross(p3 - p1);
+        if(normal.length() > 0.0)
+        {
+            Vector3 center = (p1 + p2 + p3) / 3.0;
+            addArrow(center, center + normal.normalize());
         }
     }
 }
 
 void Cloth::satisfyConstraints()
 {
-    satisfyStructuralConstraints();
-    satisfyShearConstraints();
+    if(SimulationSettings::getInstance()->getConstraintSolverMode() == COLORED_SOLVER)
+    {
+        if(coloredSolver == 0)
+        {
+            coloredSolver = new ColoredConstraintSolver(particles, &constraints);
+        }
+
+        coloredSolver->satisfyConstraints();
+    }
+    else
+    {
+        satisfyStructuralConstraints();
+        satisfyShearConstraints();
+    }
 }
 
 void Cloth::satisfyStructuralConstraints()
 {
-    satisfyConstraintsInContainer(structuralConstraints);
+    Constraint::satisfyConstraints(particles, &constraints[0], numberStructuralConstraints);
 }
 
 void Cloth::satisfyShearConstraints()
 {
-    satisfyConstraintsInContainer(shearConstraints);
+    Constraint::satisfyConstraints(particles,
+                                   &constraints[0] + numberStructuralConstraints,
+                                   constraints.size() - numberStructuralConstraints);
 }
 
-void Cloth::drawConstraints()
+void Cloth::drawConstraints(RenderPass* pass, ClothFrame* frame)
 {
-    drawStructuralConstraints();
-    drawShearConstraints();
+    drawStructuralConstraints(pass, frame);
+    drawShearConstraints(pass, frame);
 }
 
-void Cloth::drawStructuralConstraints()
+void Cloth::drawStructuralConstraints(RenderPass* pass, ClothFrame* frame)
 {
-    drawConstraintsInContainer(structuralConstraints);
-}
+    DrawingSettings* drawingSettings = pass->getSettings();
 
-void Cloth::drawShearConstraints()
-{
-    drawConstraintsInContainer(shearConstraints);
+    if(drawingSettings->isDrawStructuralConstraintsEnabled())
+    {
+        gatherConstraintLines(frame, 0, numberStructuralConstraints, &structuralLines);
+        pass->addLines(&structuralLines, drawingSettings->getStructuralConstraintColor());
+    }
 }
 
-// method for automatic drawing of constraints in a container
-void Cloth::drawConstraintsInContainer(std::vector< std::vector< std::vector<Constraint*> >* > container)
+void Cloth::drawShearConstraints(RenderPass* pass, ClothFrame* frame)
 {
-    // iterating over std::vector< std::vector< std::vector<Constraint*> >* >
-    for(std::vector< std::vector< std::vector<Constraint*> >* >::iterator it1 = container.begin();
-        it1 != container.end();
-        ++it1)
+    DrawingSettings* drawingSettings = pass->getSettings();
+
+    if(drawingSettings->isDrawShearConstraintsEnabled())
     {
-        // iterating over std::vector< std::vector<Constraint*> >*
-        for(std::vector< std::vector<Constraint*> >::iterator it2 = (*it1)->begin();
-            it2 != (*it1)->end();
-            ++it2)
-        {
-            // iterating over std::vector<Constraint*>
-            for(std::vector<Constraint*>::iterator it3 = it2->begin();
-                it3 != it2->end();
-                ++it3)
-            {
-                (*it3)->draw();
-            }
-        }
+        gatherConstraintLines(frame, numberStructuralConstraints, constraints.size(), &shearLines);
+        pass->addLines(&shearLines, drawingSettings->getShearConstraintColor());
     }
 }
 
-// method for automatic satisfaction of constraints in a container
-void Cloth::satisfyConstraintsInContainer(std::vector< std::vector< std::vector<Constraint*> >* > container)
+// gathers the enabled constraints of the table in [begin, end) as lines
+void Cloth::gatherConstraintLines(ClothFrame* frame, int begin, int end, VertexBatch* lines)
 {
-    // iterating over std::vector< std::vector< std::vector<Constraint*> >* >
-    for(std::vector< std::vector< std::vector<Constraint*> >* >::iterator it1 = container.begin();
-        it1 != container.end();
-        ++it1)
+    ParticleStore* drawn = frame->getParticles();
+
+    lines->clear();
+    for(int i = begin; i < end; i += 1)
     {
-        // iterating over std::vector< std::vector<Constraint*> >*
-        for(std::vector< std::vector<Constraint*> >::iterator it2 = (*it1)->begin();
-            it2 != (*it1)->end();
-            ++it2)
+        if(constraints[i].enabled)
         {
-            // iterating over std::vector<Constraint*>
-            for(std::vector<Constraint*>::iterator it3 = it2->begin();
-                it3 != it2->end();
-                ++it3)
-            {
-                (*it3)->satisfyConstraint();
-            }
+            int n1 = constraints[i].node1;
+            int n2 = constraints[i].node2;
+
+            lines->addVertex(drawn->positionX[n1], drawn->positionY[n1], drawn->positionZ[n1]);
+            lines->addVertex(drawn->positionX[n2], drawn->positionY[n2], drawn->positionZ[n2]);
         }
     }
 }
 
-void Cloth::createInterleavedStructuralConstraints(int inter)
+void Cloth::createInterleavedStructuralConstraints(int inter, std::vector<Constraint>* rightConstraints, std::vector<Constraint>* topConstraints)
 {
     for(int x = 0; x < numberNodesWidth; x += 1)
     {
-        std::vector<Constraint*> rightConstraintColumn;
-        std::vector<Constraint*> topConstraintColumn;
-
         for(int y = 0; y < numberNodesHeight; y += 1)
         {
             if(x < numberNodesWidth - inter)
             {
-                Node* leftNode = getNode(x, y);
-                Node* rightNode = getNode(x + inter, y);
-                rightConstraintColumn.push_back(new StructuralConstraint(leftNode, rightNode));
+                int leftNode = getNodeIndex(x, y);
+                int rightNode = getNodeIndex(x + inter, y);
+                rightConstraints->push_back(Constraint(particles, leftNode, rightNode, STRUCTURAL_CONSTRAINT));
             }
 
             if(y < numberNodesHeight - inter)
             {
-                Node* bottomNode = getNode(x, y);;
-                Node* topNode = getNode(x, y + inter);
-                topConstraintColumn.push_back(new StructuralConstraint(bottomNode, topNode));
+                int bottomNode = getNodeIndex(x, y);
+                int topNode = getNodeIndex(x, y + inter);
+                topConstraints->push_back(Constraint(particles, bottomNode, topNode, STRUCTURAL_CONSTRAINT));
             }
         }
-
-        rightStructuralConstraints.push_back(rightConstraintColumn);
-        topStructuralConstraints.push_back(topConstraintColumn);
     }
 }
 
-void Cloth::createInterleavedShearConstraints(int inter)
+void Cloth::createInterleavedShearConstraints(int inter, std::vector<Constraint>* upperRightConstraints, std::vector<Constraint>* lowerRightConstraints)
 {
     // in x direction, only go until (numberNodesWidth - inter), because no shear constraint
     // can exist towards the right after that point
     for(int x = 0; x < numberNodesWidth - inter; x += 1)
     {
-        std::vector<Constraint*> upperRightConstraintColumn;
-        std::vector<Constraint*> lowerRightConstraintColumn;
-
         // in y direction, go until extreme top, because we have to create a lower right
         // constraint
         for(int y = 0; y < numberNodesHeight; y += 1)
         {
-            Node* centerNode = getNode(x, y);
+            int centerNode = getNodeIndex(x, y);
 
-            if(y <= inter - 1)
-            {
-                // link to upper right node only
-                Node* upperRightNode = getNode(x + inter, y + inter);
-                upperRightConstraintColumn.push_back(new ShearConstraint(centerNode, upperRightNode));
-            }
-            else if(y >= numberNodesHeight - inter)
+            // a cape at most 2 * inter nodes high has rows without either
+            // neighbour, so each link is checked on its own
+            if(y + inter < numberNodesHeight)
             {
-                // link to lower right node only
-                Node* lowerRightNode = getNode(x + inter, y - inter);
-                lowerRightConstraintColumn.push_back(new ShearConstraint(centerNode, lowerRightNode));
+                int upperRightNode = getNodeIndex(x + inter, y + inter);
+                upperRightConstraints->push_back(Constraint(particles, centerNode, upperRightNode, SHEAR_CONSTRAINT));
             }
-            else
-            {
-                // link to both upper right, and lower right nodes
-                Node* upperRightNode = getNode(x + inter, y + inter);
-                Node* lowerRightNode = getNode(x + inter, y - inter);
 
-                upperRightConstraintColumn.push_back(new ShearConstraint(centerNode, upperRightNode));
-                lowerRightConstraintColumn.push_back(new ShearConstraint(centerNode, lowerRightNode));
+            if(y - inter >= 0)
+            {
+                int lowerRightNode = getNodeIndex(x + inter, y - inter);
+                lowerRightConstraints->push_back(Constraint(particles, centerNode, lowerRightNode, SHEAR_CONSTRAINT));
             }
         }
-
-        upperRightShearConstraints.push_back(upperRightConstraintColumn);
-        lowerRightShearConstraints.push_back(lowerRightConstraintColumn);
     }
-}
\ No newline at end of file
+}
@@ -4,11 +4,24 @@
 #include <vector>
 #include "Vector3.h"
 #include "Node.h"
+#include "ParticleStore.h"
 #include "Constraint.h"
-#include "StructuralConstraint.h"
-#include "ShearConstraint.h"
+#include "ColoredConstraintSolver.h"
+#include "VerletIntegrator.h"
+#include "SphereCollider.h"
+#include "SpatialHashGrid.h"
+#include "NeighborList.h"
+#include "TriangleBvh.h"
+#include "SphereGrid.h"
+#include <map>
 #include "Sphere.h"
 #include "Triangle.h"
+#include "ClothFrame.h"
+#include "ClothMesh.h"
+#include "VertexBatch.h"
+#include "SphereBatch.h"
+#include "TripleBuffer.h"
+#include "RenderPass.h"
 
 class Cloth
 {
@@ -22,27 +35,69 @@ private:
 
     int interleaving;
 
-    // Nodes
-    std::vector< std::vector<Node> > nodes;
-
-    // structural constraints
-    std::vector< std::vector< std::vector<Constraint*> >* > structuralConstraints;
-    std::vector< std::vector<Constraint*> > rightStructuralConstraints;
-    std::vector< std::vector<Constraint*> > topStructuralConstraints;
-
-    // shear constraints
-    std::vector< std::vector< std::vector<Constraint*> >* > shearConstraints;
-    std::vector< std::vector<Constraint*> > upperRightShearConstraints;
-    std::vector< std::vector<Constraint*> > lowerRightShearConstraints;
-
-    // triangles
-    // first 2 vectors contain (x, y) coordinate, and the third vector contains
-    // the 2 triangles contained in a square area
-    std::vector< std::vector< std::vector<Triangle> > > triangles;
+    // all node data, stored as contiguous arrays. Node x, y is stored at index
+    // x * numberNodesHeight + y
+    ParticleStore* particles;
+
+    // Node views on the particle store, for the code which works per node
+    std::vector<Node> nodes;
+
+    // drawn state of the cloth, published by the thread which simulates it
+    // for the one which draws it
+    TripleBuffer<ClothFrame> frames;
+    ClothMesh* mesh;
+
+    // debug drawing, refilled from the drawn frame every time it is drawn
+    VertexBatch structuralLines;
+    VertexBatch shearLines;
+    SphereBatch nodeMarkers;
+    VertexBatch arrowLines;
+    SphereBatch arrowTips;
+
+    VerletIntegrator* integrator;
+    SphereCollider* sphereCollider;
+
+    // packed table of all constraints, in solving order: the structural
+    // constraints (right, then top, each for every interleaving level) are
+    // followed by the shear constraints (upper right, then lower right)
+    std::vector<Constraint> constraints;
+    int numberStructuralConstraints;
+
+    // parallel solver over the same constraints, created when first used
+    ColoredConstraintSolver* coloredSolver;
+
+    // broadphase for each large set of spheres the cloth collides with
+    std::map<std::vector<Sphere>*, SphereGrid> sphereGrids;
+
+    // contacts with the spheres, and nodes whose force was changed by a
+    // contact since the last step
+    std::vector<Contact> contacts;
+    std::vector<int> contactedNodes;
+    int numberSphereContacts;
+
+    // number of integration steps, and step of the last sphere contacts
+    int step;
+    int contactStep;
+
+    // broadphase for self-intersections
+    SpatialHashGrid selfIntersectionGrid;
+    std::vector<int> pushedNodes;
+    NeighborList selfIntersectionNeighbors;
+
+    // node indices of the triangles, 3 per triangle, in the same order and
+    // winding as the triangles of the drawn frames
+    std::vector<int> triangleIndices;
+
+    // broadphase for node-triangle self-intersections
+    TriangleBvh triangleBvh;
+    int triangleBvhAge;
+    int numberTriangleBvhBuilds;
+    int numberTriangleContacts;
+    std::vector<int> candidateTriangles;
 
     // node creation method
     void createNodes();
-    void updateNodeNormals();
+    int getNodeIndex(int x, int y);
 
     // constraint creation methods
     void createConstraints();
@@ -50,30 +105,50 @@ private:
     void createShearConstraints();
 
     void createTriangles();
-    void updateTriangles();
+    void createFrames();
+    void reserveStepBuffers();
 
-    void createInterleavedStructuralConstraints(int inter);
-    void createInterleavedShearConstraints     (int inter);
+    void createInterleavedStructuralConstraints(int inter, std::vector<Constraint>* rightConstraints, std::vector<Constraint>* topConstraints);
+    void createInterleavedShearConstraints     (int inter, std::vector<Constraint>* upperRightConstraints, std::vector<Constraint>* lowerRightConstraints);
 
     // drawing methods
-    void drawNodes();
-    void drawConstraints();
-    void drawStructuralConstraints();
-    void drawShearConstraints();
-    void drawShaded();
+    void drawNodes(RenderPass* pass, ClothFrame* frame);
+    void drawConstraints(RenderPass* pass, ClothFrame* frame);
+    void drawStructuralConstraints(RenderPass* pass, ClothFrame* frame);
+    void drawShearConstraints(RenderPass* pass, ClothFrame* frame);
+    void drawShaded(RenderPass* pass, ClothFrame* frame);
+    void drawArrows(RenderPass* pass);
+    void addArrow(Vector3 base, Vector3 end);
+    void addFaceNormalArrows(ClothFrame* frame);
+    void gatherConstraintLines(ClothFrame* frame, int begin, int end, VertexBatch* lines);
+
+    // sphere intersection methods
+    void respondToContacts();
+    void releaseContacts();
+
+    // self-intersection methods
+    void handleSelfIntersectionsBruteForce();
+    void handleSelfIntersectionsSpatialHash();
+    void handleSelfIntersectionsNeighborList();
+    void buildSelfIntersectionNeighbors(double radius, double skin, bool skipNeighbors);
+    bool areTopologicalNeighbors(int node1, int node2);
+    bool pushOutOfBoundary(int center, int node);
+    void handleTriangleSelfIntersections();
+    bool pushOutOfTriangle(int node, int triangle, double thickness);
 
     // constraint satisfaction methods
     void satisfyStructuralConstraints();
     void satisfyShearConstraints();
 
-    void drawConstraintsInContainer(std::vector< std::vector< std::vector<Constraint*> >* > container);
-    void satisfyConstraintsInContainer(std::vector< std::vector< std::vector<Constraint*> >* > container);
-
 public:
     Cloth(float clothTotalWidth, float clothTotalHeight, int nodesWidth, int constraintInterleavingLevels);
 
-    // general drawing method
-    void draw();
+    // general drawing method, submits the latest published frame to pass
+    void draw(RenderPass* pass);
+
+    // publishes a frame with the nodes at alpha in [0, 1] between their
+    // previous and current positions
+    void updateRenderState(float alpha);
 
     // general constraint satisfaction method
     void satisfyConstraints();
@@ -88,9 +163,14 @@ public:
     float getClothWidth();
     float getClothHeight();
     Node* getNode(int x, int y);
+    ParticleStore* getParticles();
+    int getNumberConstraints();
+    int getNumberTriangleContacts();
 
     void handleSphereIntersections(std::vector<Sphere>* spheres);
     void handleSelfIntersections();
+    void showCollisionStatus();
+    void showMemoryStatus();
 };
 
 #endif
\ No newline at end of file
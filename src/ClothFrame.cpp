@@ -0,0 +1,214 @@
+#include "ClothFrame.h"
+
+#include <math.h>
+
+// columns of nodes per chunk of the normal computation
+#define CLOTH_FRAME_NORMAL_GRAIN 16
+
+ClothFrame::ClothFrame() :
+    numberNodesWidth(0),
+    numberNodesHeight(0),
+    particles(0)
+{}
+
+ClothFrame::~ClothFrame()
+{
+    delete particles;
+}
+
+void ClothFrame::create(int nodesWidth, int nodesHeight, ParticleStore* source)
+{
+    numberNodesWidth = nodesWidth;
+    numberNodesHeight = nodesHeight;
+
+    particles = new ParticleStore(numberNodesWidth * numberNodesHeight, source->getBoundaryRadius());
+    nodes.reserve(numberNodesWidth * numberNodesHeight);
+    vertices.resize(numberNodesWidth * numberNodesHeight * CLOTH_FRAME_VERTEX_SIZE);
+
+    for(int i = 0; i < numberNodesWidth * numberNodesHeight; i += 1)
+    {
+        nodes.push_back(Node(particles, i));
+    }
+
+    update(source, 1.0);
+}
+
+// The simulation runs at a fixed time step which does not match the frame
+// rate, so a frame usually falls between 2 steps. Drawing the cloth at the
+// matching point between its previous and current positions avoids the
+// stutter of drawing the last step only.
+void ClothFrame::update(ParticleStore* source, float alpha)
+{
+    int count = particles->getNumberParticles();
+
+    if(alpha >= 1.0)
+    {
+        for(int i = 0; i < count; i += 1)
+        {
+            particles->positionX[i] = source->positionX[i];
+            particles->positionY[i] = source->positionY[i];
+            particles->positionZ[i] = source->positionZ[i];
+        }
+    }
+    else
+    {
+        for(int i = 0; i < count; i += 1)
+        {
+            particles->positionX[i] = source->oldPositionX[i] + (source->positionX[i] - source->oldPositionX[i]) * alpha;
+            particles->positionY[i] = source->oldPositionY[i] + (source->positionY[i] - source->oldPositionY[i]) * alpha;
+            particles->positionZ[i] = source->oldPositionZ[i] + (source->positionZ[i] - source->oldPositionZ[i]) * alpha;
+        }
+    }
+
+    for(int i = 0; i < count; i += 1)
+    {
+        particles->forceX[i] = source->forceX[i];
+        particles->forceY[i] = source->forceY[i];
+        particles->forceZ[i] = source->forceZ[i];
+    }
+
+    updateNodeNormals();
+}
+
+int ClothFrame::getNumberNodesWidth()
+{
+    return numberNodesWidth;
+}
+
+int ClothFrame::getNumberNodesHeight()
+{
+    return numberNodesHeight;
+}
+
+ParticleStore* ClothFrame::getParticles()
+{
+    return particles;
+}
+
+long long ClothFrame::getMemorySize()
+{
+    return particles->getMemorySize() +
+           nodes.capacity() * sizeof(Node) +
+           vertices.capacity() * sizeof(float);
+}
+
+Node* ClothFrame::getNode(int x, int y)
+{
+    return &nodes[x * numberNodesHeight + y];
+}
+
+float* ClothFrame::getVertices()
+{
+    return &vertices[0];
+}
+
+void ClothFrame::updateNodeNormals()
+{
+    WorkerPool::getInstance()->run(this, numberNodesWidth, CLOTH_FRAME_NORMAL_GRAIN);
+}
+
+void ClothFrame::execute(int begin, int end)
+{
+    for(int x = begin; x < end; x += 1)
+    {
+        for(int y = 0; y < numberNodesHeight; y += 1)
+        {
+            updateNodeNormal(x, y);
+
+            int index = x * numberNodesHeight + y;
+            float* vertex = &vertices[index * CLOTH_FRAME_VERTEX_SIZE];
+
+            vertex[0] = particles->positionX[index];
+            vertex[1] = particles->positionY[index];
+            vertex[2] = particles->positionZ[index];
+            vertex[3] = particles->normalX[index];
+            vertex[4] = particles->normalY[index];
+            vertex[5] = particles->normalZ[index];
+        }
+    }
+}
+
+// The normal of a node is the normalized sum of the unit normals of the
+// triangles it belongs to: the lower triangle of the square it is the bottom
+// left corner of, both triangles of the squares it is the bottom right and top
+// left corner of, and the upper triangle of the square it is the top right
+// corner of. Squares outside the cloth are skipped.
+void ClothFrame::updateNodeNormal(int x, int y)
+{
+    int center = x * numberNodesHeight + y;
+    int left = center - numberNodesHeight;
+    int right = center + numberNodesHeight;
+
+    bool hasLeft = x > 0;
+    bool hasRight = x < numberNodesWidth - 1;
+    bool hasBottom = y > 0;
+    bool hasTop = y < numberNodesHeight - 1;
+
+    double sum[3] = {0.0, 0.0, 0.0};
+
+    // square (x, y)
+    if(hasRight && hasTop)
+    {
+        addFaceNormal(center + 1, center, right, sum);
+    }
+
+    // square (x - 1, y)
+    if(hasLeft && hasTop)
+    {
+        addFaceNormal(left + 1, left, center, sum);
+        addFaceNormal(left + 1, center, center + 1, sum);
+    }
+
+    // square (x, y - 1)
+    if(hasRight && hasBottom)
+    {
+        addFaceNormal(center, center - 1, right - 1, sum);
+        addFaceNormal(center, right - 1, right, sum);
+    }
+
+    // square (x - 1, y - 1)
+    if(hasLeft && hasBottom)
+    {
+        addFaceNormal(left, center - 1, center, sum);
+    }
+
+    double length = sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+
+    // all adjacent triangles are degenerate, keep the previous normal
+    if(length > 0.0)
+    {
+        particles->normalX[center] = sum[0] / length;
+        particles->normalY[center] = sum[1] / length;
+        particles->normalZ[center] = sum[2] / length;
+    }
+}
+
+// adds the unit normal of triangle (n1, n2, n3) to sum, unless the triangle
+// is degenerate
+void ClothFrame::addFaceNormal(int n1, int n2, int n3, double* sum)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    double edge1X = positionX[n2] - positionX[n1];
+    double edge1Y = positionY[n2] - positionY[n1];
+    double edge1Z = positionZ[n2] - positionZ[n1];
+
+    double edge2X = positionX[n3] - positionX[n1];
+    double edge2Y = positionY[n3] - positionY[n1];
+    double edge2Z = positionZ[n3] - positionZ[n1];
+
+    double normalX = edge1Y * edge2Z - edge1Z * edge2Y;
+    double normalY = edge1Z * edge2X - edge1X * edge2Z;
+    double normalZ = edge1X * edge2Y - edge1Y * edge2X;
+
+    double length = sqrt(normalX * normalX + normalY * normalY + normalZ * normalZ);
+
+    if(length > 0.0)
+    {
+        sum[0] += normalX / length;
+        sum[1] += normalY / length;
+        sum[2] += normalZ / length;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef CLOTH_FRAME_H
+#define CLOTH_FRAME_H
+
+#include <vector>
+#include "Node.h"
+#include "ParticleStore.h"
+#include "WorkerPool.h"
+
+// floats per vertex of the mesh of a frame: position, then normal
+#define CLOTH_FRAME_VERTEX_SIZE 6
+
+// Everything needed to draw a cloth at one point in time: the positions,
+// forces and normals of its nodes, and the vertices of its mesh. Frames
+// are filled by the thread which simulates the cloth and drawn by the one
+// which renders it, so drawing never reads the nodes while they are moved.
+//
+// The normals are computed in parallel over the columns of nodes, which are
+// contiguous in the particle store. Each node gathers the normals of its
+// adjacent triangles straight from the positions, so columns never write to
+// each other's nodes.
+class ClothFrame : public ParallelTask
+{
+private:
+    int numberNodesWidth;
+    int numberNodesHeight;
+
+    ParticleStore* particles;
+    std::vector<Node> nodes;
+
+    // interleaved vertices of the mesh, ready to be streamed to the renderer.
+    // Vertex i is node i
+    std::vector<float> vertices;
+
+    void updateNodeNormals();
+    void updateNodeNormal(int x, int y);
+    void addFaceNormal(int n1, int n2, int n3, double* sum);
+
+    // a frame owns its particle store, so it must not be copied
+    ClothFrame(const ClothFrame& other);
+    ClothFrame& operator=(const ClothFrame& other);
+
+public:
+    ClothFrame();
+    ~ClothFrame();
+
+    // allocates the frame for a cloth of the given size, and fills it with the
+    // positions of source
+    void create(int nodesWidth, int nodesHeight, ParticleStore* source);
+
+    // sets the nodes at alpha in [0, 1] between their previous and current
+    // positions in source, and updates their normals and the mesh
+    void update(ParticleStore* source, float alpha);
+
+    int getNumberNodesWidth();
+    int getNumberNodesHeight();
+    ParticleStore* getParticles();
+
+    // bytes of the arrays of the frame
+    long long getMemorySize();
+    Node* getNode(int x, int y);
+    float* getVertices();
+
+    // computes the normals and mesh vertices of the nodes of the columns in
+    // [begin, end)
+    void execute(int begin, int end);
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "ClothMesh.h"
+
+#ifndef HEADLESS
+// OpenGL imports. Buffer objects are part of OpenGL 1.5, which gl.h does not
+// declare without GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#include <GL/glut.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#include <GL/glext.h>
+#endif
+
+ClothMesh::ClothMesh(std::vector<int>* triangleIndices, int vertices) :
+    indices(triangleIndices->begin(), triangleIndices->end()),
+    numberVertices(vertices),
+    vertexBuffer(0),
+    indexBuffer(0),
+    buffersCreated(false)
+{}
+
+void ClothMesh::createBuffers()
+{
+#ifndef HEADLESS
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &indexBuffer);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    buffersCreated = true;
+#endif
+}
+
+#ifdef HEADLESS
+void ClothMesh::upload(ClothFrame*)
+{}
+#else
+void ClothMesh::upload(ClothFrame* frame)
+{
+    if(!buffersCreated)
+    {
+        createBuffers();
+    }
+
+    GLsizeiptr vertexBytes = numberVertices * CLOTH_FRAME_VERTEX_SIZE * sizeof(float);
+
+    // orphan the previous vertices before streaming the new ones
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, 0, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertexBytes, frame->getVertices());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+#endif
+
+void ClothMesh::draw()
+{
+#ifndef HEADLESS
+    if(!buffersCreated || indices.empty())
+    {
+        return;
+    }
+
+    GLsizei stride = CLOTH_FRAME_VERTEX_SIZE * sizeof(float);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glVertexPointer(3, GL_FLOAT, stride, (const GLvoid*) 0);
+    glNormalPointer(GL_FLOAT, stride, (const GLvoid*) (3 * sizeof(float)));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (const GLvoid*) 0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
@@ -0,0 +1,38 @@
+#ifndef CLOTH_MESH_H
+#define CLOTH_MESH_H
+
+#include <vector>
+#include "ClothFrame.h"
+
+// Draws the surface of a cloth as a single indexed triangle mesh from vertex
+// buffer objects. The triangles never change, so their indices are uploaded
+// once. The vertices of each frame are streamed to a buffer which is orphaned
+// first, so the driver never has to wait for the previous frame to be drawn
+// before the buffer can be overwritten.
+class ClothMesh
+{
+private:
+    std::vector<unsigned int> indices;
+    int numberVertices;
+
+    // buffer names, created with the first frame drawn because they need a
+    // current OpenGL context
+    unsigned int vertexBuffer;
+    unsigned int indexBuffer;
+    bool buffersCreated;
+
+    void createBuffers();
+
+public:
+    // triangleIndices holds 3 node indices per triangle
+    ClothMesh(std::vector<int>* triangleIndices, int vertices);
+
+    // streams the vertices of frame to the vertex buffer
+    void upload(ClothFrame* frame);
+
+    // draws the last uploaded vertices with the current state. The vertex and
+    // normal arrays must be enabled
+    void draw();
+};
+
+#endif
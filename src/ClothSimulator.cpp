@@ -1,5 +1,11 @@
 #include "ClothSimulator.h"
 #include "Keyboard.h"
+#include "SimulationSettings.h"
+#include "DrawingSettings.h"
+#include "Tracer.h"
+
+#include <stdlib.h>
+#include <chrono>
 
 // OpenGL imports
 #include <GL/glut.h>
@@ -18,18 +24,128 @@ ClothSimulator* ClothSimulator::getInstance()
     return instance;
 }
 
-ClothSimulator::ClothSimulator()
+ClothSimulator::ClothSimulator() :
+    simulationThreadRunning(false),
+    waitingInterfaceCalls(0),
+    simulationWasRunning(true)
 {}
 
-void ClothSimulator::simulate()
+// Called between the frames drawn by the user interface. When the scene is
+// simulated on its own thread, only the user interface changes are applied.
+// Returns true if the scene must be drawn again: the camera moved, or the
+// simulation is running or was just paused, so the last frame it published
+// is still drawn.
+bool ClothSimulator::simulate()
+{
+    lockSimulation();
+
+    bool cameraMoved = Keyboard::getInstance()->applyNormalKeyboardActions();
+
+    if(!simulationThreadRunning)
+    {
+        scheduler.advance(scene);
+    }
+
+    bool simulationRunning = DrawingSettings::getInstance()->getTimeStep() != 0.0;
+    bool changed = cameraMoved || simulationRunning || simulationWasRunning;
+    simulationWasRunning = simulationRunning;
+
+    // moving the camera does not change the scene, so the simulation thread
+    // is not woken up
+    simulationMutex.unlock();
+
+    return changed;
+}
+
+// The simulation thread runs as many steps as the scheduler allows, and
+// publishes a frame after each batch of them. The mutex is only held for one
+// batch at a time, which is bounded by the frame budget. While paused, it
+// waits until the user interface changes something.
+void ClothSimulator::runSimulationThread()
+{
+    TRACE_THREAD_NAME("simulation");
+
+    std::unique_lock<std::mutex> lock(simulationMutex, std::defer_lock);
+
+    while(simulationThreadRunning)
+    {
+        while(waitingInterfaceCalls > 0)
+        {
+            std::this_thread::yield();
+        }
+
+        lock.lock();
+        scheduler.advance(scene);
+        int substeps = scheduler.getLastSubsteps();
+
+        bool paused = false;
+        while(simulationThreadRunning && scheduler.isIdle())
+        {
+            simulationChanged.wait(lock);
+            paused = true;
+        }
+        lock.unlock();
+
+        // ahead of the simulated time rate
+        if(substeps == 0 && !paused)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void ClothSimulator::startSimulationThread()
+{
+    simulationThreadRunning = true;
+    simulationThread = std::thread(&ClothSimulator::runSimulationThread, this);
+
+    // glut leaves its main loop by calling exit()
+    atexit(stopSimulationThreadAtExit);
+}
+
+void ClothSimulator::stopSimulationThread()
+{
+    simulationMutex.lock();
+    simulationThreadRunning = false;
+    simulationChanged.notify_one();
+    simulationMutex.unlock();
+
+    if(simulationThread.joinable())
+    {
+        simulationThread.join();
+    }
+}
+
+void ClothSimulator::stopSimulationThreadAtExit()
+{
+    getInstance()->stopSimulationThread();
+}
+
+void ClothSimulator::lockSimulation()
+{
+    waitingInterfaceCalls += 1;
+    simulationMutex.lock();
+    waitingInterfaceCalls -= 1;
+}
+
+void ClothSimulator::unlockSimulation()
 {
-    Keyboard::getInstance()->applyNormalKeyboardActions();
-    scene->simulate();
+    scheduler.invalidateRenderState();
+    simulationMutex.unlock();
+
+    simulationChanged.notify_one();
+}
+
+void ClothSimulator::showSchedulerStatus()
+{
+    scheduler.showSchedulerStatus();
 }
 
 void ClothSimulator::draw()
 {
-    scene->draw();
+    renderPass.begin();
+    scene->draw(&renderPass);
+    renderPass.execute();
 }
 
 void ClothSimulator::createScene()
@@ -40,6 +156,12 @@ void ClothSimulator::createScene()
     keyboard->resetKeyboardStatus();
 
     scene = new BatmanScene();
+    scene->showMemoryStatus();
+
+    if(SimulationSettings::getInstance()->isThreadedSimulationEnabled())
+    {
+        startSimulationThread();
+    }
 }
 
 Scene* ClothSimulator::getScene()
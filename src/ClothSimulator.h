@@ -7,7 +7,13 @@
 #include "Triangle.h"
 #include "Scene.h"
 #include "BatmanScene.h"
+#include "SimulationScheduler.h"
+#include "RenderPass.h"
 #include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 class ClothSimulator;
 
@@ -17,6 +23,33 @@ private:
     static ClothSimulator* instance;
 
     Scene* scene;
+    SimulationScheduler scheduler;
+
+    // batches drawn in each frame, grouped by the OpenGL state they need
+    RenderPass renderPass;
+
+    // thread which simulates the scene when the threaded simulation is enabled
+    std::thread simulationThread;
+    std::atomic<bool> simulationThreadRunning;
+
+    // held while the scene is simulated, and while the user interface changes
+    // the scene or the settings
+    std::mutex simulationMutex;
+
+    // number of user interface calls waiting for the simulation mutex. The
+    // simulation thread lets them go first, so it can not starve them
+    std::atomic<int> waitingInterfaceCalls;
+
+    // wakes the simulation thread up when it waits for a change while paused
+    std::condition_variable simulationChanged;
+
+    // whether the simulation was running when the user interface last called
+    // simulate
+    bool simulationWasRunning;
+
+    void runSimulationThread();
+    void startSimulationThread();
+    static void stopSimulationThreadAtExit();
 
 protected:
     ClothSimulator();
@@ -26,9 +59,16 @@ public:
 
     void draw();
     void createScene();
-    void simulate();
+    bool simulate();
+    void showSchedulerStatus();
+
+    // used by the user interface around any change to the scene or settings
+    void lockSimulation();
+    void unlockSimulation();
+
+    void stopSimulationThread();
 
     Scene* getScene();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,125 @@
+#include "ColoredConstraintSolver.h"
+#include "Tracer.h"
+
+// smallest number of constraints handed to a thread at once
+#define CONSTRAINT_BATCH_GRAIN 512
+
+ColoredConstraintSolver::ColoredConstraintSolver(ParticleStore* store, std::vector<Constraint>* table) :
+    particles(store),
+    currentBatchOffset(0),
+    kernel(SCALAR_KERNEL)
+{
+    createBatches(table);
+}
+
+// greedy coloring: each pass over the remaining constraints takes every
+// constraint that touches none of the nodes already used by the current
+// batch. The first batches are therefore large, and the constraints which
+// come first in the table end up in the first batches, which keeps the
+// solving order close to the sequential one.
+void ColoredConstraintSolver::createBatches(std::vector<Constraint>* table)
+{
+    std::vector<int> nodeBatch(particles->getNumberParticles(), -1);
+
+    std::vector<int> remaining;
+    std::vector<int> postponed;
+
+    remaining.reserve(table->size());
+    postponed.reserve(table->size());
+    constraints.reserve(table->size());
+
+    for(int i = 0; i < (int) table->size(); i += 1)
+    {
+        remaining.push_back(i);
+    }
+
+    int batch = 0;
+
+    while(!remaining.empty())
+    {
+        batchOffsets.push_back(constraints.size());
+
+        for(std::vector<int>::iterator it = remaining.begin();
+            it != remaining.end();
+            ++it)
+        {
+            Constraint& constraint = (*table)[*it];
+
+            if(nodeBatch[constraint.node1] != batch && nodeBatch[constraint.node2] != batch)
+            {
+                nodeBatch[constraint.node1] = batch;
+                nodeBatch[constraint.node2] = batch;
+                constraints.push_back(constraint);
+            }
+            else
+            {
+                postponed.push_back(*it);
+            }
+        }
+
+        remaining.swap(postponed);
+        postponed.clear();
+        batch += 1;
+    }
+
+    batchOffsets.push_back(constraints.size());
+}
+
+int ColoredConstraintSolver::getNumberBatches()
+{
+    return batchOffsets.size() - 1;
+}
+
+int ColoredConstraintSolver::getBatchSize(int batch)
+{
+    return batchOffsets[batch + 1] - batchOffsets[batch];
+}
+
+void ColoredConstraintSolver::satisfyConstraints()
+{
+    WorkerPool* workerPool = WorkerPool::getInstance();
+
+    kernel = SimulationSettings::getInstance()->getSimdKernel();
+
+    for(int batch = 0; batch < getNumberBatches(); batch += 1)
+    {
+        TRACE_SCOPE("constraint batch");
+
+        int batchSize = getBatchSize(batch);
+
+        // hand out a few chunks per thread so that threads finishing early
+        // can help the others
+        int grain = batchSize / (4 * workerPool->getNumberThreads());
+        if(grain < CONSTRAINT_BATCH_GRAIN)
+        {
+            grain = CONSTRAINT_BATCH_GRAIN;
+        }
+
+        currentBatchOffset = batchOffsets[batch];
+        workerPool->run(this, batchSize, grain);
+    }
+}
+
+void ColoredConstraintSolver::execute(int begin, int end)
+{
+    Constraint* first = &constraints[currentBatchOffset + begin];
+
+    switch(kernel)
+    {
+        case AVX2_KERNEL:
+            Constraint::satisfyIndependentConstraintsAvx2(particles, first, end - begin);
+            break;
+        case SSE2_KERNEL:
+            Constraint::satisfyIndependentConstraintsSse2(particles, first, end - begin);
+            break;
+        default:
+            Constraint::satisfyConstraints(particles, first, end - begin);
+            break;
+    }
+}
+
+long long ColoredConstraintSolver::getMemorySize()
+{
+    return constraints.capacity() * sizeof(Constraint) +
+           batchOffsets.capacity() * sizeof(int);
+}
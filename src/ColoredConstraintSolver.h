@@ -0,0 +1,48 @@
+#ifndef COLORED_CONSTRAINT_SOLVER_H
+#define COLORED_CONSTRAINT_SOLVER_H
+
+#include <vector>
+#include "Constraint.h"
+#include "ParticleStore.h"
+#include "WorkerPool.h"
+#include "SimulationSettings.h"
+
+// Solves a constraint table in parallel. The constraints are partitioned
+// (graph colored) into batches in which no two constraints share a node, so
+// all the constraints of a batch can be solved at the same time. Batches are
+// solved one after the other, which keeps the Gauss-Seidel propagation of
+// corrections between batches.
+class ColoredConstraintSolver : public ParallelTask
+{
+private:
+    ParticleStore* particles;
+
+    // copy of the constraint table, reordered so each batch is contiguous.
+    // Inside a batch, constraints keep their original relative order.
+    std::vector<Constraint> constraints;
+
+    // batch i holds constraints [batchOffsets[i], batchOffsets[i + 1])
+    std::vector<int> batchOffsets;
+
+    // batch being solved by execute(), and the kernel used to solve it
+    int currentBatchOffset;
+    SimdKernel kernel;
+
+    void createBatches(std::vector<Constraint>* table);
+
+public:
+    ColoredConstraintSolver(ParticleStore* store, std::vector<Constraint>* table);
+
+    int getNumberBatches();
+    int getBatchSize(int batch);
+
+    // bytes of the sorted constraints and of the batch offsets
+    long long getMemorySize();
+
+    void satisfyConstraints();
+
+    // solves constraints [begin, end) of the current batch
+    void execute(int begin, int end);
+};
+
+#endif
@@ -1,81 +1,269 @@
 #include "Constraint.h"
+#include "ParticleStore.h"
+#include "Simd.h"
 
-// OpenGL imports
-#include <GL/glut.h>
-#include <GL/gl.h>
-#include <GL/glu.h>
-
-void Constraint::draw()
-{
-    if(enabled)
-    {
-        Vector3 firstNodePosition = node1->getPosition();
-        Vector3 secondNodePosition = node2->getPosition();
-        glBegin(GL_LINES);
-            glVertex3f(firstNodePosition.x, firstNodePosition.y, firstNodePosition.z);
-            glVertex3f(secondNodePosition.x, secondNodePosition.y, secondNodePosition.z);
-        glEnd();
-    }
-}
-
-Constraint::Constraint(Node* n1, Node* n2) :
+Constraint::Constraint(ParticleStore* particles, int n1, int n2, ConstraintType constraintType) :
     node1(n1),
     node2(n2),
-    distanceAtRest((n1->getPosition() - n2->getPosition()).length()),
-    enabled(true)
+    distanceAtRest((particles->getPosition(n1) - particles->getPosition(n2)).length()),
+    type(constraintType),
+    enabled(1)
 {}
 
 void Constraint::disable()
 {
-    enabled = false;
+    enabled = 0;
 }
 
-Node* Constraint::getFirstNode()
+void Constraint::satisfyConstraints(ParticleStore* particles, Constraint* constraints, int numberConstraints)
 {
-    return node1;
-}
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+    unsigned char* pinned = particles->pinned;
 
-Node* Constraint::getSecondNode()
-{
-    return node2;
+    for(int i = 0; i < numberConstraints; i += 1)
+    {
+        Constraint* constraint = &constraints[i];
+
+        if(constraint->enabled)
+        {
+            int n1 = constraint->node1;
+            int n2 = constraint->node2;
+
+            double fromNode1ToNode2X = positionX[n2] - positionX[n1];
+            double fromNode1ToNode2Y = positionY[n2] - positionY[n1];
+            double fromNode1ToNode2Z = positionZ[n2] - positionZ[n1];
+
+            double currentDistance = sqrt(fromNode1ToNode2X * fromNode1ToNode2X +
+                                          fromNode1ToNode2Y * fromNode1ToNode2Y +
+                                          fromNode1ToNode2Z * fromNode1ToNode2Z);
+            double restToCurrentDistanceRatio = constraint->distanceAtRest / currentDistance;
+
+            // correction vector from node1 to node2
+            double correctionX = fromNode1ToNode2X * (1 - restToCurrentDistanceRatio);
+            double correctionY = fromNode1ToNode2Y * (1 - restToCurrentDistanceRatio);
+            double correctionZ = fromNode1ToNode2Z * (1 - restToCurrentDistanceRatio);
+
+            bool node1Moveable = !pinned[n1];
+            bool node2Moveable = !pinned[n2];
+
+            if(node1Moveable && node2Moveable)
+            {
+                // move both nodes towards each other by 0.5 * correction
+                // positive direction for node1 (correction vector goes from node1 to node 2)
+                // therefore, negative direction for node2
+                positionX[n1] += 0.5 * correctionX;
+                positionY[n1] += 0.5 * correctionY;
+                positionZ[n1] += 0.5 * correctionZ;
+
+                positionX[n2] -= 0.5 * correctionX;
+                positionY[n2] -= 0.5 * correctionY;
+                positionZ[n2] -= 0.5 * correctionZ;
+            }
+            else if(node1Moveable && !node2Moveable)
+            {
+                // move node1 towards node2 by +1.0 * correction
+                positionX[n1] += correctionX;
+                positionY[n1] += correctionY;
+                positionZ[n1] += correctionZ;
+            }
+            else if(!node1Moveable && node2Moveable)
+            {
+                // move node2 towards node1 by -1.0 * correction
+                positionX[n2] -= correctionX;
+                positionY[n2] -= correctionY;
+                positionZ[n2] -= correctionZ;
+            }
+        }
+    }
 }
 
-float Constraint::getDistanceAtRest()
+
+#ifdef SIMD_X86_ENABLED
+
+SIMD_TARGET_SSE2
+void Constraint::satisfyIndependentConstraintsSse2(ParticleStore* particles, Constraint* constraints, int numberConstraints)
 {
-    return distanceAtRest;
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+    double* mobility = particles->mobility;
+
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d tiny = _mm_set1_pd(1e-300);
+
+    int i = 0;
+
+    for(; i + 2 <= numberConstraints; i += 2)
+    {
+        Constraint* c0 = &constraints[i];
+        Constraint* c1 = &constraints[i + 1];
+
+        int a0 = c0->node1;
+        int a1 = c1->node1;
+        int b0 = c0->node2;
+        int b1 = c1->node2;
+
+        __m128d x1 = _mm_set_pd(positionX[a1], positionX[a0]);
+        __m128d y1 = _mm_set_pd(positionY[a1], positionY[a0]);
+        __m128d z1 = _mm_set_pd(positionZ[a1], positionZ[a0]);
+        __m128d x2 = _mm_set_pd(positionX[b1], positionX[b0]);
+        __m128d y2 = _mm_set_pd(positionY[b1], positionY[b0]);
+        __m128d z2 = _mm_set_pd(positionZ[b1], positionZ[b0]);
+
+        __m128d w1 = _mm_set_pd(mobility[a1], mobility[a0]);
+        __m128d w2 = _mm_set_pd(mobility[b1], mobility[b0]);
+
+        __m128d distanceAtRest = _mm_set_pd(c1->distanceAtRest, c0->distanceAtRest);
+        __m128d enabled = _mm_castsi128_pd(_mm_set_epi64x(c1->enabled ? -1 : 0, c0->enabled ? -1 : 0));
+
+        __m128d dx = _mm_sub_pd(x2, x1);
+        __m128d dy = _mm_sub_pd(y2, y1);
+        __m128d dz = _mm_sub_pd(z2, z1);
+
+        __m128d currentDistance = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz)));
+        __m128d factor = _mm_sub_pd(one, _mm_div_pd(distanceAtRest, currentDistance));
+
+        // disabled constraints apply no correction
+        factor = _mm_and_pd(factor, enabled);
+
+        __m128d correctionX = _mm_mul_pd(dx, factor);
+        __m128d correctionY = _mm_mul_pd(dy, factor);
+        __m128d correctionZ = _mm_mul_pd(dz, factor);
+
+        // share of the correction taken by each node: 0.5 / 0.5 when both can
+        // move, 1.0 / 0.0 when one is pinned, nothing when both are pinned
+        __m128d totalMobility = _mm_max_pd(_mm_add_pd(w1, w2), tiny);
+        __m128d share1 = _mm_div_pd(w1, totalMobility);
+        __m128d share2 = _mm_div_pd(w2, totalMobility);
+
+        x1 = _mm_add_pd(x1, _mm_mul_pd(correctionX, share1));
+        y1 = _mm_add_pd(y1, _mm_mul_pd(correctionY, share1));
+        z1 = _mm_add_pd(z1, _mm_mul_pd(correctionZ, share1));
+        x2 = _mm_sub_pd(x2, _mm_mul_pd(correctionX, share2));
+        y2 = _mm_sub_pd(y2, _mm_mul_pd(correctionY, share2));
+        z2 = _mm_sub_pd(z2, _mm_mul_pd(correctionZ, share2));
+
+        // no scatter instruction, store the lanes one by one
+        _mm_storel_pd(&positionX[a0], x1);
+        _mm_storeh_pd(&positionX[a1], x1);
+        _mm_storel_pd(&positionY[a0], y1);
+        _mm_storeh_pd(&positionY[a1], y1);
+        _mm_storel_pd(&positionZ[a0], z1);
+        _mm_storeh_pd(&positionZ[a1], z1);
+
+        _mm_storel_pd(&positionX[b0], x2);
+        _mm_storeh_pd(&positionX[b1], x2);
+        _mm_storel_pd(&positionY[b0], y2);
+        _mm_storeh_pd(&positionY[b1], y2);
+        _mm_storel_pd(&positionZ[b0], z2);
+        _mm_storeh_pd(&positionZ[b1], z2);
+    }
+
+    satisfyConstraints(particles, constraints + i, numberConstraints - i);
 }
 
-void Constraint::satisfyConstraint()
+SIMD_TARGET_AVX2
+void Constraint::satisfyIndependentConstraintsAvx2(ParticleStore* particles, Constraint* constraints, int numberConstraints)
 {
-    if(enabled)
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+    double* mobility = particles->mobility;
+
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d tiny = _mm256_set1_pd(1e-300);
+
+    int i = 0;
+
+    for(; i + 4 <= numberConstraints; i += 4)
     {
-        Vector3 vectorFromNode1ToNode2 = node2->getPosition() - node1->getPosition();
-        float currentDistance = vectorFromNode1ToNode2.length();
-        float restToCurrentDistanceRatio = distanceAtRest / currentDistance;
-        Vector3 correctionVectorFromNode1ToNode2 = vectorFromNode1ToNode2 * (1 - restToCurrentDistanceRatio);
+        Constraint* c = &constraints[i];
 
-        bool node1Moveable = node1->isMoveable();
-        bool node2Moveable = node2->isMoveable();
+        int a0 = c[0].node1;
+        int a1 = c[1].node1;
+        int a2 = c[2].node1;
+        int a3 = c[3].node1;
+        int b0 = c[0].node2;
+        int b1 = c[1].node2;
+        int b2 = c[2].node2;
+        int b3 = c[3].node2;
 
-        if(node1Moveable && node2Moveable)
-        {
-            // move both nodes towards each other by 0.5 * correctionVectorFromNode1ToNode2
-            // positive direction for node1 (correction vector goes from node1 to node 2)
-            // therefore, negative direction for node2
-            node1->translate(0.5 * correctionVectorFromNode1ToNode2);
-            node2->translate(-0.5 * correctionVectorFromNode1ToNode2);
-        }
-        else if(node1Moveable && !node2Moveable)
-        {
-            // move node1 towards node2 by +1.0 * correctionVectorFromNode1ToNode2
-            // (positive sign, because the correction vector is pointing towards node2)
-            node1->translate(correctionVectorFromNode1ToNode2);
-        }
-        else if(!node1Moveable && node2Moveable)
-        {
-            // move node2 towards node1 by -1.0 * correctionVectorFromNode1ToNode2
-            // (negative sign, because the correction vector is pointing towards node2)
-            node2->translate(-correctionVectorFromNode1ToNode2);
-        }
+        // gather instructions are slower than plain loads on most cpus
+        __m256d x1 = _mm256_set_pd(positionX[a3], positionX[a2], positionX[a1], positionX[a0]);
+        __m256d y1 = _mm256_set_pd(positionY[a3], positionY[a2], positionY[a1], positionY[a0]);
+        __m256d z1 = _mm256_set_pd(positionZ[a3], positionZ[a2], positionZ[a1], positionZ[a0]);
+        __m256d x2 = _mm256_set_pd(positionX[b3], positionX[b2], positionX[b1], positionX[b0]);
+        __m256d y2 = _mm256_set_pd(positionY[b3], positionY[b2], positionY[b1], positionY[b0]);
+        __m256d z2 = _mm256_set_pd(positionZ[b3], positionZ[b2], positionZ[b1], positionZ[b0]);
+
+        __m256d w1 = _mm256_set_pd(mobility[a3], mobility[a2], mobility[a1], mobility[a0]);
+        __m256d w2 = _mm256_set_pd(mobility[b3], mobility[b2], mobility[b1], mobility[b0]);
+
+        __m256d distanceAtRest = _mm256_set_pd(c[3].distanceAtRest, c[2].distanceAtRest, c[1].distanceAtRest, c[0].distanceAtRest);
+        __m256d enabled = _mm256_castsi256_pd(_mm256_set_epi64x(c[3].enabled ? -1 : 0,
+                                                                c[2].enabled ? -1 : 0,
+                                                                c[1].enabled ? -1 : 0,
+                                                                c[0].enabled ? -1 : 0));
+
+        __m256d dx = _mm256_sub_pd(x2, x1);
+        __m256d dy = _mm256_sub_pd(y2, y1);
+        __m256d dz = _mm256_sub_pd(z2, z1);
+
+        __m256d currentDistance = _mm256_sqrt_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz)));
+        __m256d factor = _mm256_sub_pd(one, _mm256_div_pd(distanceAtRest, currentDistance));
+
+        // disabled constraints apply no correction
+        factor = _mm256_and_pd(factor, enabled);
+
+        __m256d correctionX = _mm256_mul_pd(dx, factor);
+        __m256d correctionY = _mm256_mul_pd(dy, factor);
+        __m256d correctionZ = _mm256_mul_pd(dz, factor);
+
+        // share of the correction taken by each node: 0.5 / 0.5 when both can
+        // move, 1.0 / 0.0 when one is pinned, nothing when both are pinned
+        __m256d totalMobility = _mm256_max_pd(_mm256_add_pd(w1, w2), tiny);
+        __m256d share1 = _mm256_div_pd(w1, totalMobility);
+        __m256d share2 = _mm256_div_pd(w2, totalMobility);
+
+        x1 = _mm256_add_pd(x1, _mm256_mul_pd(correctionX, share1));
+        y1 = _mm256_add_pd(y1, _mm256_mul_pd(correctionY, share1));
+        z1 = _mm256_add_pd(z1, _mm256_mul_pd(correctionZ, share1));
+        x2 = _mm256_sub_pd(x2, _mm256_mul_pd(correctionX, share2));
+        y2 = _mm256_sub_pd(y2, _mm256_mul_pd(correctionY, share2));
+        z2 = _mm256_sub_pd(z2, _mm256_mul_pd(correctionZ, share2));
+
+        // avx2 has no scatter instruction, store the lanes one by one
+        double lanes[6][4] __attribute__((aligned(32)));
+        _mm256_store_pd(lanes[0], x1);
+        _mm256_store_pd(lanes[1], y1);
+        _mm256_store_pd(lanes[2], z1);
+        _mm256_store_pd(lanes[3], x2);
+        _mm256_store_pd(lanes[4], y2);
+        _mm256_store_pd(lanes[5], z2);
+
+        positionX[a0] = lanes[0][0]; positionX[a1] = lanes[0][1]; positionX[a2] = lanes[0][2]; positionX[a3] = lanes[0][3];
+        positionY[a0] = lanes[1][0]; positionY[a1] = lanes[1][1]; positionY[a2] = lanes[1][2]; positionY[a3] = lanes[1][3];
+        positionZ[a0] = lanes[2][0]; positionZ[a1] = lanes[2][1]; positionZ[a2] = lanes[2][2]; positionZ[a3] = lanes[2][3];
+        positionX[b0] = lanes[3][0]; positionX[b1] = lanes[3][1]; positionX[b2] = lanes[3][2]; positionX[b3] = lanes[3][3];
+        positionY[b0] = lanes[4][0]; positionY[b1] = lanes[4][1]; positionY[b2] = lanes[4][2]; positionY[b3] = lanes[4][3];
+        positionZ[b0] = lanes[5][0]; positionZ[b1] = lanes[5][1]; positionZ[b2] = lanes[5][2]; positionZ[b3] = lanes[5][3];
     }
-}
\ No newline at end of file
+
+    satisfyConstraints(particles, constraints + i, numberConstraints - i);
+}
+
+#else
+
+void Constraint::satisfyIndependentConstraintsSse2(ParticleStore* particles, Constraint* constraints, int numberConstraints)
+{
+    satisfyConstraints(particles, constraints, numberConstraints);
+}
+
+void Constraint::satisfyIndependentConstraintsAvx2(ParticleStore* particles, Constraint* constraints, int numberConstraints)
+{
+    satisfyConstraints(particles, constraints, numberConstraints);
+}
+
+#endif
@@ -1,25 +1,40 @@
 #ifndef CONSTRAINT_H
 #define CONSTRAINT_H
 
-#include "Node.h"
+class ParticleStore;
 
+enum ConstraintType
+{
+    STRUCTURAL_CONSTRAINT,
+    SHEAR_CONSTRAINT
+};
+
+// A distance constraint between two nodes, packed into 16 bytes so a whole
+// table of them can be streamed by the solver. The nodes are referenced by
+// their index in the cloth's particle store.
 class Constraint
 {
-private:
-    Node* node1;
-    Node* node2;
+public:
+    int node1;
+    int node2;
     float distanceAtRest;
-    bool enabled;
+    unsigned char type;
+    unsigned char enabled;
+
+    Constraint(ParticleStore* particles, int n1, int n2, ConstraintType constraintType);
 
-public:
-    Constraint(Node* n1, Node* n2);
-    Node* getFirstNode();
-    Node* getSecondNode();
-    float getDistanceAtRest();
-    void satisfyConstraint();
     void disable();
 
-    virtual void draw();
+    // satisfies numberConstraints consecutive constraints, in order
+    static void satisfyConstraints(ParticleStore* particles, Constraint* constraints, int numberConstraints);
+
+    // same as satisfyConstraints, for constraints which do not share any node
+    // (a batch of the colored solver), solving 2 (sse2) or 4 (avx2) of them per
+    // instruction. Pinned nodes are handled by weighting the corrections with
+    // the particle store mobility instead of branching, which gives the same
+    // results as the scalar version.
+    static void satisfyIndependentConstraintsSse2(ParticleStore* particles, Constraint* constraints, int numberConstraints);
+    static void satisfyIndependentConstraintsAvx2(ParticleStore* particles, Constraint* constraints, int numberConstraints);
 };
 
-#endif
\ No newline at end of file
+#endif
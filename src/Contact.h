@@ -0,0 +1,33 @@
+#ifndef CONTACT_H
+#define CONTACT_H
+
+// contacts a node gets at most in practice, with overlapping colliders. The
+// contact lists are reserved for this many per node, so they do not grow
+// during a step
+#define CONTACTS_PER_NODE 8
+
+// A node found inside a collider. normal is the unit vector pointing out of
+// the collider at the node, and depth how far the node must move along it to
+// get back onto the surface of the collider.
+class Contact
+{
+public:
+    int node;
+    int collider;
+
+    double normalX;
+    double normalY;
+    double normalZ;
+    double depth;
+
+    Contact(int contactNode, int contactCollider, double nx, double ny, double nz, double contactDepth) :
+        node(contactNode),
+        collider(contactCollider),
+        normalX(nx),
+        normalY(ny),
+        normalZ(nz),
+        depth(contactDepth)
+    {}
+};
+
+#endif
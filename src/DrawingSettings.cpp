@@ -1,10 +1,12 @@
 #include "DrawingSettings.h"
 #include <iostream>
 
+#ifndef HEADLESS
 // OpenGL imports
 #include <GL/glut.h>
 #include <GL/gl.h>
 #include <GL/glu.h>
+#endif
 
 DrawingSettings* DrawingSettings::instance = 0;
 
@@ -161,6 +163,7 @@ std::string DrawingSettings::isEnabled(bool controlVariableEnabled)
 // determines if a wireframe is to be drawn, or a textured version
 void DrawingSettings::chooseRenderingMethod()
 {
+#ifndef HEADLESS
     if(drawWireFrameEnabled)
     {
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -169,6 +172,7 @@ void DrawingSettings::chooseRenderingMethod()
     {
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
+#endif
 }
 
 Vector3 DrawingSettings::getNodesColor()
@@ -1,10 +1,12 @@
 #include "Floor.h"
 #include "DrawingSettings.h"
 
+#ifndef HEADLESS
 // OpenGL imports
 #include <GL/glut.h>
 #include <GL/gl.h>
 #include <GL/glu.h>
+#endif
 
 // provide corners in counter-clockwise order, and normal will be facing upwards
 Floor::Floor(Vector3 tl, Vector3 bl, Vector3 br, Vector3 tr) :
@@ -17,6 +19,7 @@ Floor::Floor(Vector3 tl, Vector3 bl, Vector3 br, Vector3 tr) :
 
 void Floor::draw()
 {
+#ifndef HEADLESS
     DrawingSettings* drawingSettings = DrawingSettings::getInstance();
 
     if(drawingSettings->isDrawFloorEnabled())
@@ -36,6 +39,7 @@ void Floor::draw()
             glPopAttrib(); // GL_CURRENT_BIT
         glPopAttrib(); // GL_POLYGON_BIT
     }
+#endif
 }
 
 void Floor::handleNodeIntersection(Node* node)
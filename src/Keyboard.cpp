@@ -2,6 +2,9 @@
 #include "Camera.h"
 #include "ClothSimulator.h"
 #include "DrawingSettings.h"
+#include "SimulationSettings.h"
+#include "Profiler.h"
+#include "Tracer.h"
 
 // OpenGL imports
 #include <GL/glut.h>
@@ -36,9 +39,11 @@ void Keyboard::resetKeyboardStatus()
 
 // Note that these are the CONTINUOUS actions only. For toggle state actions,
 // take care of it before the array of keyboard button status is enabled.
-void Keyboard::applyNormalKeyboardActions()
+// Returns true if the camera moved.
+bool Keyboard::applyNormalKeyboardActions()
 {
     Camera* camera = ClothSimulator::getInstance()->getScene()->getCamera();
+    bool cameraMoved = false;
 
     for(int key = 0; key < 256; key += 1)
     {
@@ -120,10 +125,15 @@ void Keyboard::applyNormalKeyboardActions()
                     break;
 
                 default:
-                    break;
+                    // held keys without a continuous action
+                    continue;
             } // end switch(key)
+
+            cameraMoved = true;
         } // end if(keyboardStatus[key])
     } // end loop
+
+    return cameraMoved;
 }
 
 // Put toggle keyboard controls here, and continuous ones in the "default" part of
@@ -143,6 +153,46 @@ void Keyboard::handleNormalKeyboardInput(unsigned char key, int x, int y)
         case '3':
             drawingSettings->toggleDrawTrianglesEnabled();
             break;
+        case '4':
+            SimulationSettings::getInstance()->toggleConstraintSolverMode();
+            break;
+        case '5':
+            SimulationSettings::getInstance()->toggleSimdKernel();
+            break;
+        case '6':
+            SimulationSettings::getInstance()->toggleSelfCollisionMode();
+            break;
+        case '7':
+            SimulationSettings::getInstance()->toggleTriangleSelfCollisionEnabled();
+            break;
+        case '8':
+            SimulationSettings::getInstance()->toggleInterpolationEnabled();
+            break;
+#ifdef ENABLE_PROFILER
+        case '9':
+            Profiler::getInstance()->toggleOverlayEnabled();
+            break;
+#endif
+#ifdef ENABLE_TRACER
+        case '0':
+            if(Tracer::isEnabled())
+            {
+                Tracer::getInstance()->writeTrace();
+            }
+            break;
+#endif
+        case '+':
+            SimulationSettings::getInstance()->setSimulatedTimeRate(SimulationSettings::getInstance()->getSimulatedTimeRate() * 2.0);
+            break;
+        case '-':
+            SimulationSettings::getInstance()->setSimulatedTimeRate(SimulationSettings::getInstance()->getSimulatedTimeRate() / 2.0);
+            break;
+        case ']':
+            SimulationSettings::getInstance()->setConstraintIterations(SimulationSettings::getInstance()->getConstraintIterations() + 1);
+            break;
+        case '[':
+            SimulationSettings::getInstance()->setConstraintIterations(SimulationSettings::getInstance()->getConstraintIterations() - 1);
+            break;
         case 32:
             spacebarPressed = !spacebarPressed;
 
@@ -196,6 +246,13 @@ void Keyboard::handleSpecialKeyboardInput(int key, int x, int y)
             drawingSettings->toggleDrawShearConstraintsEnabled();
             break;
         case GLUT_KEY_F7:
+            SimulationSettings::getInstance()->showSimulationStatus();
+            ClothSimulator::getInstance()->getScene()->showSimulationStatus();
+            ClothSimulator::getInstance()->getScene()->showMemoryStatus();
+            ClothSimulator::getInstance()->showSchedulerStatus();
+#ifdef ENABLE_PROFILER
+            Profiler::getInstance()->showProfilerStatus();
+#endif
             break;
         case GLUT_KEY_F8:
             break;
@@ -243,6 +300,7 @@ void Keyboard::showHelp()
     std::cout << "status controls:" << std::endl;
     std::cout << "  F3: show camera status" << std::endl;
     std::cout << "  F4: show draw   status" << std::endl;
+    std::cout << "  F7: show simulation status" << std::endl;
 
     std::cout << std::endl;
 
@@ -250,7 +308,6 @@ void Keyboard::showHelp()
     std::cout << "drawing controls:" << std::endl;
     std::cout << "  F5   : toggle draw structural      constraints" << std::endl;
     std::cout << "  F6   : toggle draw shear           constraints" << std::endl;
-    std::cout << "  F7   : toggle draw structural bend constraints" << std::endl;
     std::cout << "  F8   : toggle draw shear      bend constraints" << std::endl;
     std::cout << "  F9   : toggle draw nodes" << std::endl;
     std::cout << "  F10  : toggle draw wireframe" << std::endl;
@@ -259,6 +316,19 @@ void Keyboard::showHelp()
     std::cout << "  1    : toggle draw arrows" << std::endl;
     std::cout << "  2    : toggle draw floor" << std::endl;
     std::cout << "  3    : toggle draw triangles" << std::endl;
+    std::cout << "  4    : toggle sequential / colored parallel constraint solver" << std::endl;
+    std::cout << "  5    : cycle vectorized kernels (scalar, sse2, avx2)" << std::endl;
+    std::cout << "  6    : cycle self collision mode (brute force, spatial hash, neighbor list)" << std::endl;
+    std::cout << "  7    : toggle node-triangle self collision" << std::endl;
+    std::cout << "  8    : toggle interpolation between simulated states" << std::endl;
+#ifdef ENABLE_PROFILER
+    std::cout << "  9    : toggle profiler overlay" << std::endl;
+#endif
+#ifdef ENABLE_TRACER
+    std::cout << "  0    : write the trace (when started with --trace)" << std::endl;
+#endif
+    std::cout << "  +/-  : double / halve simulated time rate" << std::endl;
+    std::cout << "  ]/[  : increase / decrease constraint iterations per step" << std::endl;
     std::cout << "  space: toggle pause" << std::endl;
 
     std::cout << std::endl;
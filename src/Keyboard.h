@@ -23,7 +23,7 @@ public:
     void resetKeyboardStatus();
     void handleNormalKeyboardInput(unsigned char key, int x, int y);
     void handleNormalKeyboardRelease(unsigned char key, int x, int y);
-    void applyNormalKeyboardActions();
+    bool applyNormalKeyboardActions();
 
     void handleSpecialKeyboardInput(int key, int x, int y);
 
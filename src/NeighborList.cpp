@@ -0,0 +1,114 @@
+#include "NeighborList.h"
+
+// pairs per node the list is sized for when it is built. The cloth has about
+// 4 to 6 in practice, so the list does not grow between builds even when it
+// folds onto itself
+#define NEIGHBOR_LIST_RESERVED_PAIRS 16
+
+NeighborList::NeighborList() :
+    radius(0.0),
+    skin(0.0),
+    skipNeighbors(false),
+    invalid(true),
+    numberBuilds(0),
+    numberUpdates(0)
+{}
+
+bool NeighborList::needsRebuild(ParticleStore* particles, double interactionRadius, double skinMargin, bool skipTopologicalNeighbors)
+{
+    int numberParticles = particles->getNumberParticles();
+
+    if(invalid ||
+       interactionRadius != radius ||
+       skinMargin != skin ||
+       skipTopologicalNeighbors != skipNeighbors ||
+       (int) referenceX.size() != numberParticles)
+    {
+        return true;
+    }
+
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    double maximumDisplacementSquared = 0.25 * skin * skin;
+
+    for(int i = 0; i < numberParticles; i += 1)
+    {
+        double dx = positionX[i] - referenceX[i];
+        double dy = positionY[i] - referenceY[i];
+        double dz = positionZ[i] - referenceZ[i];
+
+        if(dx * dx + dy * dy + dz * dz > maximumDisplacementSquared)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void NeighborList::beginBuild(ParticleStore* particles, double interactionRadius, double skinMargin, bool skipTopologicalNeighbors)
+{
+    int numberParticles = particles->getNumberParticles();
+
+    radius = interactionRadius;
+    skin = skinMargin;
+    skipNeighbors = skipTopologicalNeighbors;
+    invalid = false;
+
+    referenceX.assign(particles->positionX, particles->positionX + numberParticles);
+    referenceY.assign(particles->positionY, particles->positionY + numberParticles);
+    referenceZ.assign(particles->positionZ, particles->positionZ + numberParticles);
+
+    offsets.clear();
+    neighbors.clear();
+    offsets.reserve(numberParticles + 1);
+    neighbors.reserve(numberParticles * NEIGHBOR_LIST_RESERVED_PAIRS);
+    offsets.push_back(0);
+
+    numberBuilds += 1;
+}
+
+void NeighborList::checkDisplacement(ParticleStore* particles, int node)
+{
+    double dx = particles->positionX[node] - referenceX[node];
+    double dy = particles->positionY[node] - referenceY[node];
+    double dz = particles->positionZ[node] - referenceZ[node];
+
+    if(dx * dx + dy * dy + dz * dz > 0.25 * skin * skin)
+    {
+        invalid = true;
+    }
+}
+
+void NeighborList::countUpdate()
+{
+    numberUpdates += 1;
+}
+
+double NeighborList::getSearchRadius()
+{
+    return radius + skin;
+}
+
+int NeighborList::getNumberBuilds()
+{
+    return numberBuilds;
+}
+
+int NeighborList::getNumberUpdates()
+{
+    return numberUpdates;
+}
+
+int NeighborList::getNumberPairs()
+{
+    return neighbors.size();
+}
+
+long long NeighborList::getMemorySize()
+{
+    return (offsets.capacity() + neighbors.capacity()) * sizeof(int) +
+           (referenceX.capacity() + referenceY.capacity() + referenceZ.capacity()) * sizeof(double);
+}
@@ -0,0 +1,85 @@
+#ifndef NEIGHBOR_LIST_H
+#define NEIGHBOR_LIST_H
+
+#include <vector>
+#include "ParticleStore.h"
+
+// Verlet neighbor list: for each node, the nodes which were closer than
+// (interaction radius + skin) when the list was built. As long as no node has
+// moved more than half the skin since then, every pair of nodes closer than
+// the interaction radius is still in the list, so the list can be reused
+// from step to step instead of searching for candidates again.
+class NeighborList
+{
+private:
+    // candidates of node i are neighbors[offsets[i]] .. neighbors[offsets[i + 1] - 1]
+    std::vector<int> offsets;
+    std::vector<int> neighbors;
+
+    // positions of the nodes when the list was built
+    std::vector<double> referenceX;
+    std::vector<double> referenceY;
+    std::vector<double> referenceZ;
+
+    // parameters the list was built with
+    double radius;
+    double skin;
+    bool skipNeighbors;
+
+    // set when a node is known to have moved too far since the last build
+    bool invalid;
+
+    int numberBuilds;
+    int numberUpdates;
+
+public:
+    NeighborList();
+
+    // true if the list must be rebuilt before it can be used with the given
+    // parameters
+    bool needsRebuild(ParticleStore* particles, double interactionRadius, double skinMargin, bool skipTopologicalNeighbors);
+
+    // building a list: call beginBuild, then for each node in order, add its
+    // candidates and call endNode
+    void beginBuild(ParticleStore* particles, double interactionRadius, double skinMargin, bool skipTopologicalNeighbors);
+    void addNeighbor(int node)
+    {
+        neighbors.push_back(node);
+    }
+    void endNode()
+    {
+        offsets.push_back(neighbors.size());
+    }
+
+    // checks if a node moved by something else than the integration (a push
+    // while the list is being used) went further than half the skin
+    void checkDisplacement(ParticleStore* particles, int node);
+
+    // counts one use of the list
+    void countUpdate();
+
+    int getNeighborsBegin(int node)
+    {
+        return offsets[node];
+    }
+
+    int getNeighborsEnd(int node)
+    {
+        return offsets[node + 1];
+    }
+
+    int getNeighbor(int k)
+    {
+        return neighbors[k];
+    }
+
+    double getSearchRadius();
+    int getNumberBuilds();
+    int getNumberUpdates();
+    int getNumberPairs();
+
+    // bytes of the arrays
+    long long getMemorySize();
+};
+
+#endif
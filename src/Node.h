@@ -3,46 +3,33 @@
 
 #include "Vector3.h"
 
-class Sphere;
+class ParticleStore;
 
+// A Node is a thin view on one entry of a ParticleStore. It holds no state of
+// its own, so it is cheap to copy and every change made through it is seen by
+// the loops that operate on the store directly.
 class Node
 {
 private:
-    Vector3 position;
-    Vector3 oldPosition;
-    bool moveable;
-    Vector3 originalForce;
-    Vector3 force;
-    float mass;
-    Sphere* boundary;
-    Vector3 normal;
+    ParticleStore* particles;
+    int index;
 
 public:
-    Node();
-    Node(Vector3 pos, float boundaryRadius);
+    Node(ParticleStore* store, int i);
+
+    int getIndex();
 
     Vector3 getPosition();
-    Vector3 getOldPosition();
-    Vector3 getForce();
     Vector3 getNormal();
 
     void setMoveable(bool isMovePossible);
     void setMass(float m);
     void setPosition(Vector3 pos);
-    void setForce(Vector3 f);
     void setNormal(Vector3 n);
 
-    bool isMoveable();
     void translate(Vector3 direction);
 
-    void draw();
-
     void addForce(Vector3 extraForce);
-    void applyForces(float duration);
-
-    void resetToOriginalForce();
-
-    void handleNodeIntersection(Node* node);
 };
 
-#endif
\ No newline at end of file
+#endif
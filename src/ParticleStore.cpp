@@ -0,0 +1,140 @@
+#include "ParticleStore.h"
+
+#include <stdlib.h>
+#include <new>
+
+ParticleStore::ParticleStore(int count, float nodeBoundaryRadius) :
+    numberParticles(count),
+    paddedNumberParticles(((count + PARTICLE_STORE_PADDING - 1) / PARTICLE_STORE_PADDING) * PARTICLE_STORE_PADDING),
+    boundaryRadius(nodeBoundaryRadius)
+{
+    positionX = allocateDoubleArray(0.0);
+    positionY = allocateDoubleArray(0.0);
+    positionZ = allocateDoubleArray(0.0);
+
+    oldPositionX = allocateDoubleArray(0.0);
+    oldPositionY = allocateDoubleArray(0.0);
+    oldPositionZ = allocateDoubleArray(0.0);
+
+    forceX = allocateDoubleArray(0.0);
+    forceY = allocateDoubleArray(0.0);
+    forceZ = allocateDoubleArray(0.0);
+
+    originalForceX = allocateDoubleArray(0.0);
+    originalForceY = allocateDoubleArray(0.0);
+    originalForceZ = allocateDoubleArray(0.0);
+
+    normalX = allocateDoubleArray(0.0);
+    normalY = allocateDoubleArray(0.0);
+    normalZ = allocateDoubleArray(1.0);
+
+    inverseMass = allocateDoubleArray(1.0);
+    pinned = allocateByteArray(0);
+    contact = allocateByteArray(0);
+    mobility = allocateDoubleArray(1.0);
+
+    // padding entries must never move
+    for(int i = numberParticles; i < paddedNumberParticles; i += 1)
+    {
+        pinned[i] = 1;
+        mobility[i] = 0.0;
+    }
+}
+
+ParticleStore::~ParticleStore()
+{
+    free(positionX);
+    free(positionY);
+    free(positionZ);
+
+    free(oldPositionX);
+    free(oldPositionY);
+    free(oldPositionZ);
+
+    free(forceX);
+    free(forceY);
+    free(forceZ);
+
+    free(originalForceX);
+    free(originalForceY);
+    free(originalForceZ);
+
+    free(normalX);
+    free(normalY);
+    free(normalZ);
+
+    free(inverseMass);
+    free(pinned);
+    free(contact);
+    free(mobility);
+}
+
+double* ParticleStore::allocateDoubleArray(double initialValue)
+{
+    void* memory = 0;
+
+    if(posix_memalign(&memory, PARTICLE_STORE_ALIGNMENT, paddedNumberParticles * sizeof(double)) != 0)
+    {
+        throw std::bad_alloc();
+    }
+
+    double* array = static_cast<double*>(memory);
+
+    for(int i = 0; i < paddedNumberParticles; i += 1)
+    {
+        array[i] = initialValue;
+    }
+
+    return array;
+}
+
+unsigned char* ParticleStore::allocateByteArray(unsigned char initialValue)
+{
+    void* memory = 0;
+
+    if(posix_memalign(&memory, PARTICLE_STORE_ALIGNMENT, paddedNumberParticles * sizeof(unsigned char)) != 0)
+    {
+        throw std::bad_alloc();
+    }
+
+    unsigned char* array = static_cast<unsigned char*>(memory);
+
+    for(int i = 0; i < paddedNumberParticles; i += 1)
+    {
+        array[i] = initialValue;
+    }
+
+    return array;
+}
+
+int ParticleStore::getNumberParticles()
+{
+    return numberParticles;
+}
+
+int ParticleStore::getPaddedNumberParticles()
+{
+    return paddedNumberParticles;
+}
+
+// 17 arrays of doubles and 2 of bytes, see the constructor
+long long ParticleStore::getMemorySize()
+{
+    return (long long) paddedNumberParticles * (17 * sizeof(double) + 2 * sizeof(unsigned char));
+}
+
+float ParticleStore::getBoundaryRadius()
+{
+    return boundaryRadius;
+}
+
+void ParticleStore::setMass(int i, float m)
+{
+    inverseMass[i] = 1.0 / m;
+}
+
+void ParticleStore::setPinned(int i, bool isPinned)
+{
+    pinned[i] = isPinned ? 1 : 0;
+    mobility[i] = isPinned ? 0.0 : 1.0;
+}
@@ -0,0 +1,141 @@
+#ifndef PARTICLE_STORE_H
+#define PARTICLE_STORE_H
+
+#include "Vector3.h"
+
+// Structure-of-arrays storage for all the nodes of a cloth. Every quantity of
+// a node lives in its own contiguous, cache line aligned array, so the
+// integration, constraint and collision loops can stream over the nodes
+// instead of hopping between fat Node objects.
+//
+// The arrays are padded to a multiple of PARTICLE_STORE_PADDING elements. The
+// padding entries are pinned and never referenced by a constraint, which lets
+// vectorized loops run over whole blocks without a scalar remainder.
+#define PARTICLE_STORE_ALIGNMENT 64
+#define PARTICLE_STORE_PADDING 8
+
+class ParticleStore
+{
+private:
+    int numberParticles;
+    int paddedNumberParticles;
+
+    // radius of the sphere around each node used for self-intersections
+    float boundaryRadius;
+
+    double* allocateDoubleArray(double initialValue);
+    unsigned char* allocateByteArray(unsigned char initialValue);
+
+    // a store owns its arrays, so it must not be copied
+    ParticleStore(const ParticleStore& other);
+    ParticleStore& operator=(const ParticleStore& other);
+
+public:
+    // position of each node
+    double* positionX;
+    double* positionY;
+    double* positionZ;
+
+    // position of each node at the previous time step (verlet integration)
+    double* oldPositionX;
+    double* oldPositionY;
+    double* oldPositionZ;
+
+    // force currently applied to each node
+    double* forceX;
+    double* forceY;
+    double* forceZ;
+
+    // force applied to each node when it is not in contact with anything
+    double* originalForceX;
+    double* originalForceY;
+    double* originalForceZ;
+
+    // normal of the surface at each node (only used for drawing)
+    double* normalX;
+    double* normalY;
+    double* normalZ;
+
+    double* inverseMass;
+
+    // non-zero for nodes which can not move
+    unsigned char* pinned;
+
+    // non-zero for nodes which touched a sphere during the current step, and
+    // whose force is reduced to its tangent part
+    unsigned char* contact;
+
+    // 1.0 for nodes which can move, 0.0 for pinned ones. Mirrors pinned, so
+    // vectorized loops can weight corrections instead of branching
+    double* mobility;
+
+    ParticleStore(int count, float nodeBoundaryRadius);
+    ~ParticleStore();
+
+    int getNumberParticles();
+    int getPaddedNumberParticles();
+
+    // bytes of all the arrays
+    long long getMemorySize();
+    float getBoundaryRadius();
+
+    Vector3 getPosition(int i)
+    {
+        return Vector3(positionX[i], positionY[i], positionZ[i]);
+    }
+
+    Vector3 getOldPosition(int i)
+    {
+        return Vector3(oldPositionX[i], oldPositionY[i], oldPositionZ[i]);
+    }
+
+    Vector3 getForce(int i)
+    {
+        return Vector3(forceX[i], forceY[i], forceZ[i]);
+    }
+
+    Vector3 getNormal(int i)
+    {
+        return Vector3(normalX[i], normalY[i], normalZ[i]);
+    }
+
+    void setPosition(int i, Vector3 pos)
+    {
+        positionX[i] = pos.x;
+        positionY[i] = pos.y;
+        positionZ[i] = pos.z;
+    }
+
+    void setOldPosition(int i, Vector3 pos)
+    {
+        oldPositionX[i] = pos.x;
+        oldPositionY[i] = pos.y;
+        oldPositionZ[i] = pos.z;
+    }
+
+    void setForce(int i, Vector3 f)
+    {
+        forceX[i] = f.x;
+        forceY[i] = f.y;
+        forceZ[i] = f.z;
+    }
+
+    void setNormal(int i, Vector3 n)
+    {
+        normalX[i] = n.x;
+        normalY[i] = n.y;
+        normalZ[i] = n.z;
+    }
+
+    void resetToOriginalForce(int i)
+    {
+        forceX[i] = originalForceX[i];
+        forceY[i] = originalForceY[i];
+        forceZ[i] = originalForceZ[i];
+    }
+
+    void setMass(int i, float m);
+    void setPinned(int i, bool isPinned);
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "PerfCounters.h"
+
+#include <atomic>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+// counters of one thread
+class PerfCounterGroup
+{
+public:
+    bool opened;
+
+    // file descriptor of each counter, -1 when it is not available. The first
+    // available one leads the group
+    int descriptors[NUMBER_PERF_COUNTERS];
+    int leader;
+
+    // position of each counter in the values read from the group
+    int positions[NUMBER_PERF_COUNTERS];
+    int numberOpened;
+
+    PerfCounterGroup() :
+        opened(false),
+        leader(-1),
+        numberOpened(0)
+    {
+        for(int i = 0; i < NUMBER_PERF_COUNTERS; i += 1)
+        {
+            descriptors[i] = -1;
+            positions[i] = -1;
+        }
+    }
+};
+
+static thread_local PerfCounterGroup threadGroup;
+
+static std::atomic<bool> multiplexed(false);
+
+#ifdef __linux__
+static void setCounterEvent(perf_event_attr* attributes, PerfCounter counter)
+{
+    switch(counter)
+    {
+        case PERF_CYCLES:
+            attributes->type = PERF_TYPE_HARDWARE;
+            attributes->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_INSTRUCTIONS:
+            attributes->type = PERF_TYPE_HARDWARE;
+            attributes->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_L1D_MISSES:
+            attributes->type = PERF_TYPE_HW_CACHE;
+            attributes->config = PERF_COUNT_HW_CACHE_L1D |
+                                 (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PERF_LLC_MISSES:
+            attributes->type = PERF_TYPE_HARDWARE;
+            attributes->config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PERF_BRANCH_MISSES:
+            attributes->type = PERF_TYPE_HARDWARE;
+            attributes->config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+
+        default:
+            break;
+    }
+}
+#endif
+
+bool PerfCounters::open()
+{
+    PerfCounterGroup* group = &threadGroup;
+
+    if(group->opened)
+    {
+        return group->numberOpened > 0;
+    }
+
+    group->opened = true;
+
+#ifdef __linux__
+    for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+    {
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        setCounterEvent(&attributes, (PerfCounter) counter);
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        // the leader starts disabled, and enables the whole group once it is
+        // complete
+        attributes.disabled = group->leader == -1 ? 1 : 0;
+
+        int descriptor = syscall(__NR_perf_event_open, &attributes, 0, -1, group->leader, 0);
+        if(descriptor == -1)
+        {
+            continue;
+        }
+
+        if(group->leader == -1)
+        {
+            group->leader = descriptor;
+        }
+
+        group->descriptors[counter] = descriptor;
+        group->positions[counter] = group->numberOpened;
+        group->numberOpened += 1;
+    }
+
+    if(group->leader != -1)
+    {
+        ioctl(group->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+
+    return group->numberOpened > 0;
+}
+
+bool PerfCounters::read(long long values[NUMBER_PERF_COUNTERS])
+{
+    for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+    {
+        values[counter] = PERF_COUNTER_UNAVAILABLE;
+    }
+
+    if(!open())
+    {
+        return false;
+    }
+
+#ifdef __linux__
+    PerfCounterGroup* group = &threadGroup;
+
+    // number of values, time the group was enabled and time it was counting,
+    // followed by the values
+    unsigned long long buffer[NUMBER_PERF_COUNTERS + 3];
+    if(::read(group->leader, buffer, sizeof(buffer)) < (ssize_t) ((group->numberOpened + 3) * sizeof(unsigned long long)))
+    {
+        return false;
+    }
+
+    unsigned long long enabled = buffer[1];
+    unsigned long long running = buffer[2];
+
+    if(running == 0)
+    {
+        return false;
+    }
+
+    // the group only counted for part of the time, so the values are scaled
+    // to the whole time
+    double scale = 1.0;
+    if(running < enabled)
+    {
+        scale = (double) enabled / running;
+        multiplexed.store(true, std::memory_order_relaxed);
+    }
+
+    for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+    {
+        if(group->positions[counter] != -1)
+        {
+            values[counter] = (long long) (buffer[3 + group->positions[counter]] * scale);
+        }
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool PerfCounters::wasMultiplexed()
+{
+    return multiplexed.load(std::memory_order_relaxed);
+}
+
+std::string PerfCounters::getCounterName(PerfCounter counter)
+{
+    switch(counter)
+    {
+        case PERF_CYCLES:
+            return "cycles";
+        case PERF_INSTRUCTIONS:
+            return "instructions";
+        case PERF_L1D_MISSES:
+            return "l1d misses";
+        case PERF_LLC_MISSES:
+            return "llc misses";
+        case PERF_BRANCH_MISSES:
+            return "branch misses";
+
+        default:
+            return "unknown";
+    }
+}
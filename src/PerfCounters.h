@@ -0,0 +1,55 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <string>
+
+// Hardware performance counters of the calling thread, read with Linux
+// perf_event_open. The counters of each thread are opened as one group the
+// first time the thread reads them, so they are all counted over the same
+// instructions. Only user space is counted, which most systems allow without
+// privileges.
+//
+// When more counters are asked for than the CPU has, the system multiplexes
+// them, and each one only counts for part of the time. Their values are then
+// scaled up to the whole time, which makes them estimates.
+//
+// Only the calling thread is counted, so the work a phase hands to the
+// worker pool is not.
+//
+// Counters the CPU or the system does not provide (virtual machines often
+// provide none) are reported as unavailable, and the caller falls back to
+// timing only.
+
+enum PerfCounter
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+
+    NUMBER_PERF_COUNTERS
+};
+
+// value of the counters which could not be opened
+#define PERF_COUNTER_UNAVAILABLE -1
+
+class PerfCounters
+{
+public:
+    // opens the counters of the calling thread if needed. Returns false if
+    // none of them can be read
+    static bool open();
+
+    // reads the counters of the calling thread, values being set to
+    // PERF_COUNTER_UNAVAILABLE for the ones which are not available. Returns
+    // false if none of them can be read
+    static bool read(long long values[NUMBER_PERF_COUNTERS]);
+
+    // true if a read of any thread found its counters multiplexed
+    static bool wasMultiplexed();
+
+    static std::string getCounterName(PerfCounter counter);
+};
+
+#endif
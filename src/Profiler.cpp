@@ -0,0 +1,359 @@
+#include "Profiler.h"
+#include "SimulationSettings.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <stdlib.h>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#ifndef HEADLESS
+// OpenGL imports
+#include <GL/glut.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
+
+Profiler* Profiler::instance = 0;
+
+Profiler* Profiler::getInstance()
+{
+    if(instance == 0)
+    {
+        instance = new Profiler();
+    }
+
+    return instance;
+}
+
+Profiler::Profiler() :
+    numberFrames(0),
+    countersEnabled(false),
+    overlayEnabled(false),
+    csvHeaderWritten(false)
+{
+    for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+    {
+        frameTimes[phase] = 0;
+
+        for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+        {
+            frameCounters[phase][counter] = 0;
+            totalCounters[phase][counter] = 0;
+        }
+    }
+
+    for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+    {
+        counterAvailable[counter] = false;
+    }
+}
+
+void Profiler::addTime(ProfilePhase phase, long long nanoseconds)
+{
+    frameTimes[phase].fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+void Profiler::addCounters(ProfilePhase phase, long long* begin, long long* end)
+{
+    for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+    {
+        if(begin[counter] != PERF_COUNTER_UNAVAILABLE && end[counter] != PERF_COUNTER_UNAVAILABLE)
+        {
+            frameCounters[phase][counter].fetch_add(end[counter] - begin[counter], std::memory_order_relaxed);
+            counterAvailable[counter].store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool Profiler::enableCounters()
+{
+    countersEnabled = PerfCounters::open();
+    return countersEnabled;
+}
+
+bool Profiler::areCountersEnabled()
+{
+    return countersEnabled;
+}
+
+void Profiler::endFrame()
+{
+    double* times = history[numberFrames % PROFILER_HISTORY];
+
+    for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+    {
+        times[phase] = frameTimes[phase].exchange(0, std::memory_order_relaxed) / 1000000.0;
+    }
+
+    long long counters[NUMBER_PROFILE_PHASES][NUMBER_PERF_COUNTERS];
+    for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+    {
+        for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+        {
+            counters[phase][counter] = frameCounters[phase][counter].exchange(0, std::memory_order_relaxed);
+            totalCounters[phase][counter] += counters[phase][counter];
+        }
+    }
+
+    if(csv.is_open())
+    {
+        if(!csvHeaderWritten)
+        {
+            writeCsvHeader();
+        }
+
+        csv << numberFrames;
+        for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+        {
+            csv << "," << times[phase];
+        }
+
+        if(countersEnabled)
+        {
+            for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+            {
+                for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+                {
+                    csv << "," << counters[phase][counter];
+                }
+            }
+        }
+
+        csv << "\n";
+    }
+
+    numberFrames += 1;
+}
+
+double Profiler::getAverageTime(ProfilePhase phase)
+{
+    int count = numberFrames < PROFILER_HISTORY ? numberFrames : PROFILER_HISTORY;
+    if(count == 0)
+    {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    for(int i = 0; i < count; i += 1)
+    {
+        sum += history[i][phase];
+    }
+
+    return sum / count;
+}
+
+bool Profiler::openCsv(std::string path)
+{
+    csv.open(path.c_str());
+
+    // the profiler is never destroyed, so nothing else would flush the file
+    if(csv.is_open())
+    {
+        atexit(closeCsvAtExit);
+    }
+
+    return csv.is_open();
+}
+
+void Profiler::closeCsv()
+{
+    if(csv.is_open())
+    {
+        csv.close();
+    }
+}
+
+void Profiler::closeCsvAtExit()
+{
+    getInstance()->closeCsv();
+}
+
+// written with the first line, once it is known whether counters are enabled
+void Profiler::writeCsvHeader()
+{
+    // times in milliseconds
+    csv << "frame";
+    for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+    {
+        csv << "," << getPhaseName((ProfilePhase) phase);
+    }
+
+    // the counters which are not available stay at 0
+    if(countersEnabled)
+    {
+        for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+        {
+            for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+            {
+                csv << "," << getPhaseName((ProfilePhase) phase) << " " << PerfCounters::getCounterName((PerfCounter) counter);
+            }
+        }
+    }
+
+    csv << "\n";
+    csvHeaderWritten = true;
+}
+
+bool Profiler::isOverlayEnabled()
+{
+    return overlayEnabled;
+}
+
+void Profiler::toggleOverlayEnabled()
+{
+    overlayEnabled = !overlayEnabled;
+}
+
+#ifndef HEADLESS
+void Profiler::drawOverlay()
+{
+    if(!overlayEnabled)
+    {
+        return;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // window coordinates, with the origin in the lower left corner
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0.0, viewport[2], 0.0, viewport[3]);
+
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT); // save depth test, lighting and color
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_LIGHTING);
+        glColor3f(1.0, 1.0, 0.0);
+
+        for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+        {
+            std::ostringstream line;
+            line << std::setw(22) << std::left << getPhaseName((ProfilePhase) phase)
+                 << std::setw(8) << std::right << std::fixed << std::setprecision(3)
+                 << getAverageTime((ProfilePhase) phase) << " ms";
+
+            std::string text = line.str();
+
+            glRasterPos2i(10, viewport[3] - 20 - 15 * phase);
+            for(unsigned int i = 0; i < text.size(); i += 1)
+            {
+                glutBitmapCharacter(GLUT_BITMAP_8_BY_13, text[i]);
+            }
+        }
+    glPopAttrib(); // GL_ENABLE_BIT | GL_CURRENT_BIT
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
+#endif
+
+void Profiler::showProfilerStatus()
+{
+    std::cout << "profiler status (average over the last " << PROFILER_HISTORY << " frames):" << std::endl;
+
+    for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+    {
+        std::string name = getPhaseName((ProfilePhase) phase);
+        std::cout << "  " << name << std::string(32 - name.size(), ' ') << ": " << getAverageTime((ProfilePhase) phase) << " ms" << std::endl;
+    }
+
+    std::cout << std::endl;
+
+    if(countersEnabled)
+    {
+        std::cout << "hardware counters (total over " << numberFrames << " frames, and per frame):" << std::endl;
+
+        // the counters follow the thread running the phase, and not the
+        // workers it hands its work to
+        if(SimulationSettings::getInstance()->getNumberThreads() > 1)
+        {
+            std::cout << "  calling thread only, the work done by the other " << SimulationSettings::getInstance()->getNumberThreads() - 1 << " threads is not counted" << std::endl;
+        }
+
+        if(PerfCounters::wasMultiplexed())
+        {
+            std::cout << "  the counters were multiplexed, their values are scaled estimates" << std::endl;
+        }
+
+        for(int phase = 0; phase < NUMBER_PROFILE_PHASES; phase += 1)
+        {
+            showCounters((ProfilePhase) phase);
+        }
+
+        std::cout << std::endl;
+    }
+}
+
+void Profiler::showCounters(ProfilePhase phase)
+{
+    long long* totals = totalCounters[phase];
+
+    // phases which did not run, like the drawing ones in headless runs
+    bool counted = false;
+    for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+    {
+        counted = counted || totals[counter] != 0;
+    }
+
+    if(!counted)
+    {
+        return;
+    }
+
+    std::cout << "  " << getPhaseName(phase) << ":" << std::endl;
+
+    for(int counter = 0; counter < NUMBER_PERF_COUNTERS; counter += 1)
+    {
+        std::string name = PerfCounters::getCounterName((PerfCounter) counter);
+        std::cout << "    " << name << std::string(30 - name.size(), ' ') << ": ";
+
+        if(counterAvailable[counter])
+        {
+            std::cout << totals[counter] << " (" << (double) totals[counter] / numberFrames << ")" << std::endl;
+        }
+        else
+        {
+            std::cout << "unavailable" << std::endl;
+        }
+    }
+
+    if(counterAvailable[PERF_CYCLES] && counterAvailable[PERF_INSTRUCTIONS] && totals[PERF_CYCLES] > 0)
+    {
+        std::cout << "    instructions per cycle        : " << (double) totals[PERF_INSTRUCTIONS] / totals[PERF_CYCLES] << std::endl;
+    }
+}
+
+std::string Profiler::getPhaseName(ProfilePhase phase)
+{
+    switch(phase)
+    {
+        case PROFILE_APPLY_FORCES:
+            return "apply forces";
+        case PROFILE_SATISFY_CONSTRAINTS:
+            return "satisfy constraints";
+        case PROFILE_SPHERE_INTERSECTIONS:
+            return "sphere intersections";
+        case PROFILE_SELF_INTERSECTIONS:
+            return "self intersections";
+        case PROFILE_SIMULATION:
+            return "simulation";
+        case PROFILE_CLOTH_DRAW:
+            return "cloth draw";
+        case PROFILE_RENDER_PASS:
+            return "render pass";
+
+        default:
+            return "unknown";
+    }
+}
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Measures how long each phase of a step and of a frame takes. Phases are
+// timed with PROFILE_SCOPE, which adds the time spent in the enclosing block
+// to the current frame. At the end of each frame, the totals are kept in a
+// rolling history, shown in an overlay, and optionally written as a line of
+// a csv file.
+//
+// When hardware counters are enabled, each phase also counts the cycles,
+// instructions, cache misses and branch misses of the thread running it. The
+// counters are read around each timed block, which costs a system call at
+// each end of it, so they are off unless asked for.
+//
+// Everything is compiled only when ENABLE_PROFILER is defined. Otherwise
+// PROFILE_SCOPE expands to nothing, and the code using the profiler directly
+// must be guarded by ENABLE_PROFILER too.
+
+enum ProfilePhase
+{
+    PROFILE_APPLY_FORCES,
+    PROFILE_SATISFY_CONSTRAINTS,
+    PROFILE_SPHERE_INTERSECTIONS,
+    PROFILE_SELF_INTERSECTIONS,
+
+    // everything simulated for a frame, including the phases above
+    PROFILE_SIMULATION,
+
+    // gathering the batches of the cloth, and drawing all the batches
+    PROFILE_CLOTH_DRAW,
+    PROFILE_RENDER_PASS,
+
+    NUMBER_PROFILE_PHASES
+};
+
+#ifdef ENABLE_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include "PerfCounters.h"
+#include "AllocationCounter.h"
+
+// number of frames the averages are computed over
+#define PROFILER_HISTORY 60
+
+#define PROFILE_SCOPE(phase) ProfileScope profileScope(phase)
+
+class Profiler
+{
+private:
+    static Profiler* instance;
+
+    // time spent in each phase during the current frame, in nanoseconds. The
+    // phases may be timed on another thread than the one ending the frame
+    std::atomic<long long> frameTimes[NUMBER_PROFILE_PHASES];
+
+    // milliseconds spent in each phase during the last frames
+    double history[PROFILER_HISTORY][NUMBER_PROFILE_PHASES];
+    int numberFrames;
+
+    // counted events in each phase during the current frame, and since the
+    // start
+    bool countersEnabled;
+    std::atomic<bool> counterAvailable[NUMBER_PERF_COUNTERS];
+    std::atomic<long long> frameCounters[NUMBER_PROFILE_PHASES][NUMBER_PERF_COUNTERS];
+    long long totalCounters[NUMBER_PROFILE_PHASES][NUMBER_PERF_COUNTERS];
+
+    bool overlayEnabled;
+    std::ofstream csv;
+    bool csvHeaderWritten;
+
+    void writeCsvHeader();
+    static void closeCsvAtExit();
+    void showCounters(ProfilePhase phase);
+
+protected:
+    Profiler();
+
+public:
+    static Profiler* getInstance();
+
+    void addTime(ProfilePhase phase, long long nanoseconds);
+
+    // adds the events counted between 2 readings of the counters
+    void addCounters(ProfilePhase phase, long long* begin, long long* end);
+
+    // counts hardware events in the phases from now on. Returns false, and
+    // leaves them off, if the counters can not be read
+    bool enableCounters();
+    bool areCountersEnabled();
+
+    // moves the times of the current frame to the history and the csv file
+    void endFrame();
+
+    // average milliseconds spent in phase per frame, over the last frames
+    double getAverageTime(ProfilePhase phase);
+
+    // writes a line per frame to path, from the next frame on. Returns false
+    // if the file can not be opened
+    bool openCsv(std::string path);
+
+    // writes the lines still buffered and closes the file. Also done at exit
+    void closeCsv();
+
+    bool isOverlayEnabled();
+    void toggleOverlayEnabled();
+
+#ifndef HEADLESS
+    // draws the averages on top of the frame
+    void drawOverlay();
+#endif
+
+    void showProfilerStatus();
+
+    static std::string getPhaseName(ProfilePhase phase);
+};
+
+// adds the time between its construction and its destruction to a phase, and
+// charges the allocations made meanwhile by the thread to it when the
+// allocation counter is built
+class ProfileScope
+{
+private:
+    ProfilePhase phase;
+#ifdef ENABLE_ALLOCATION_COUNTER
+    int previousPhase;
+#endif
+    bool counting;
+    long long startCounters[NUMBER_PERF_COUNTERS];
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ProfileScope(ProfilePhase p) :
+        phase(p),
+#ifdef ENABLE_ALLOCATION_COUNTER
+        previousPhase(AllocationCounter::enterPhase(p)),
+#endif
+        counting(Profiler::getInstance()->areCountersEnabled())
+    {
+        if(counting)
+        {
+            PerfCounters::read(startCounters);
+        }
+
+        start = std::chrono::steady_clock::now();
+    }
+
+    ~ProfileScope()
+    {
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+        Profiler* profiler = Profiler::getInstance();
+
+        if(counting)
+        {
+            long long endCounters[NUMBER_PERF_COUNTERS];
+            PerfCounters::read(endCounters);
+            profiler->addCounters(phase, startCounters, endCounters);
+        }
+
+        profiler->addTime(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+#ifdef ENABLE_ALLOCATION_COUNTER
+        AllocationCounter::leavePhase(previousPhase);
+#endif
+    }
+};
+
+#else
+
+#define PROFILE_SCOPE(phase)
+
+#endif
+
+#endif
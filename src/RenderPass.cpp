@@ -0,0 +1,120 @@
+#include "RenderPass.h"
+#include "Profiler.h"
+#include "Tracer.h"
+
+#ifndef HEADLESS
+// OpenGL imports
+#include <GL/glut.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
+
+RenderPass::RenderPass() :
+    settings(*DrawingSettings::getInstance())
+{}
+
+void RenderPass::begin()
+{
+    settings = *DrawingSettings::getInstance();
+
+    meshes.clear();
+    litSpheres.clear();
+    flatSpheres.clear();
+    lines.clear();
+}
+
+DrawingSettings* RenderPass::getSettings()
+{
+    return &settings;
+}
+
+void RenderPass::addMesh(ClothMesh* mesh, Vector3 color)
+{
+    meshes.push_back(ColoredBatch<ClothMesh>(mesh, color));
+}
+
+void RenderPass::addSpheres(SphereBatch* spheres, Vector3 color, bool lit)
+{
+    if(lit)
+    {
+        litSpheres.push_back(ColoredBatch<SphereBatch>(spheres, color));
+    }
+    else
+    {
+        flatSpheres.push_back(ColoredBatch<SphereBatch>(spheres, color));
+    }
+}
+
+void RenderPass::addLines(VertexBatch* batch, Vector3 color)
+{
+    lines.push_back(ColoredBatch<VertexBatch>(batch, color));
+}
+
+#ifndef HEADLESS
+void RenderPass::setMaterial(Vector3 color)
+{
+    GLfloat mat_amb_diff[] = {(GLfloat) color.x, (GLfloat) color.y, (GLfloat) color.z, 1.0};
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, mat_amb_diff);
+}
+#endif
+
+void RenderPass::execute()
+{
+#ifndef HEADLESS
+    PROFILE_SCOPE(PROFILE_RENDER_PASS);
+    TRACE_SCOPE("render pass");
+
+    glPushAttrib(GL_POLYGON_BIT | GL_CURRENT_BIT | GL_LIGHTING_BIT | GL_TRANSFORM_BIT); // save mesh settings, color, lighting and normal rescaling
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+
+        // lit surfaces
+        glEnable(GL_LIGHTING);
+        glEnable(GL_LIGHT0);
+
+        // the cloth is seen from both sides, and follows the wireframe setting
+        glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+        settings.chooseRenderingMethod();
+
+        for(std::vector< ColoredBatch<ClothMesh> >::iterator it = meshes.begin(); it != meshes.end(); ++it)
+        {
+            setMaterial(it->color);
+            it->batch->draw();
+        }
+
+        // spheres are always filled. They are scaled unit spheres, so their
+        // normals are scaled back to unit length
+        glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_FALSE);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glEnable(GL_RESCALE_NORMAL);
+
+        for(std::vector< ColoredBatch<SphereBatch> >::iterator it = litSpheres.begin(); it != litSpheres.end(); ++it)
+        {
+            setMaterial(it->color);
+            it->batch->draw();
+        }
+
+        // flat spheres
+        glDisable(GL_LIGHTING);
+
+        for(std::vector< ColoredBatch<SphereBatch> >::iterator it = flatSpheres.begin(); it != flatSpheres.end(); ++it)
+        {
+            glColor3f(it->color.x, it->color.y, it->color.z);
+            it->batch->draw();
+        }
+
+        // lines
+        glDisableClientState(GL_NORMAL_ARRAY);
+
+        for(std::vector< ColoredBatch<VertexBatch> >::iterator it = lines.begin(); it != lines.end(); ++it)
+        {
+            glColor3f(it->color.x, it->color.y, it->color.z);
+            it->batch->draw();
+        }
+
+    glPopClientAttrib(); // GL_CLIENT_VERTEX_ARRAY_BIT
+    glPopAttrib(); // GL_POLYGON_BIT | GL_CURRENT_BIT | GL_LIGHTING_BIT | GL_TRANSFORM_BIT
+#endif
+}
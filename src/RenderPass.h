@@ -0,0 +1,62 @@
+#ifndef RENDER_PASS_H
+#define RENDER_PASS_H
+
+#include <vector>
+#include "Vector3.h"
+#include "DrawingSettings.h"
+#include "ClothMesh.h"
+#include "SphereBatch.h"
+#include "VertexBatch.h"
+
+// batch submitted to a render pass, with the color it is drawn in
+template <typename T>
+class ColoredBatch
+{
+public:
+    T* batch;
+    Vector3 color;
+
+    ColoredBatch(T* b, Vector3 c) :
+        batch(b),
+        color(c)
+    {}
+};
+
+// Everything drawn in one frame. The drawing settings are copied once when
+// the pass begins, and every drawing method reads that copy instead of the
+// shared settings. The batches submitted during the frame are drawn at the
+// end, grouped by the OpenGL state they need (lit surfaces, flat spheres,
+// lines), and each state is set once per group instead of being pushed and
+// popped around every primitive.
+class RenderPass
+{
+private:
+    DrawingSettings settings;
+
+    std::vector< ColoredBatch<ClothMesh> > meshes;
+    std::vector< ColoredBatch<SphereBatch> > litSpheres;
+    std::vector< ColoredBatch<SphereBatch> > flatSpheres;
+    std::vector< ColoredBatch<VertexBatch> > lines;
+
+#ifndef HEADLESS
+    void setMaterial(Vector3 color);
+#endif
+
+public:
+    RenderPass();
+
+    // takes the settings for the frame, and forgets the previous batches
+    void begin();
+
+    DrawingSettings* getSettings();
+
+    // the batches must stay unchanged until the pass is executed
+    void addMesh(ClothMesh* mesh, Vector3 color);
+    void addSpheres(SphereBatch* spheres, Vector3 color, bool lit);
+    void addLines(VertexBatch* batch, Vector3 color);
+
+    // draws all the batches submitted since begin
+    void execute();
+};
+
+#endif
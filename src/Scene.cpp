@@ -1,10 +1,11 @@
 #include "Scene.h"
-#include "DrawingSettings.h"
 
+#ifndef HEADLESS
 // OpenGL imports
 #include <GL/glut.h>
 #include <GL/gl.h>
 #include <GL/glu.h>
+#endif
 
 Scene::Scene()
 {}
@@ -24,13 +25,30 @@ Camera* Scene::getCamera()
     return camera;
 }
 
-void Scene::drawWorldAxis()
+void Scene::updateRenderState(float)
+{}
+
+void Scene::showSimulationStatus()
+{}
+
+void Scene::showMemoryStatus()
+{}
+
+// the axis are only a few primitives, so they are drawn right away instead of
+// being submitted to the pass
+#ifdef HEADLESS
+void Scene::drawWorldAxis(RenderPass*)
+{}
+#else
+void Scene::drawWorldAxis(RenderPass* pass)
 {
-    if(DrawingSettings::getInstance()->isDrawWorldAxisEnabled())
+    if(pass->getSettings()->isDrawWorldAxisEnabled())
     {
         glPushAttrib(GL_POLYGON_BIT ); // save mesh settings
             glPushAttrib(GL_CURRENT_BIT); // save color
 
+                pass->getSettings()->chooseRenderingMethod();
+
                 glColor3f(1.0, 0.0, 0.0);
                 // x-axis in red
                 glBegin(GL_LINES);
@@ -69,4 +87,5 @@ void Scene::drawWorldAxis()
             glPopAttrib(); // GL_CURRENT_BIT
         glPopAttrib(); // GL_POLYGON_BIT
     }
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define SCENE_H
 
 #include "Camera.h"
+#include "RenderPass.h"
 
 class Scene
 {
@@ -18,12 +19,22 @@ public:
     float getFarPlane();
     Camera* getCamera();
 
-    void drawWorldAxis();
+    void drawWorldAxis(RenderPass* pass);
 
     // you must not instantiate Scene, but only descendants, because they will have
     // the draw and simulate methods needed to animate themselves correctly.
-    virtual void draw() = 0;
+    virtual void draw(RenderPass* pass) = 0;
     virtual void simulate() = 0;
+
+    // prepares the scene to be drawn at alpha in [0, 1] between its last 2
+    // simulated states
+    virtual void updateRenderState(float alpha);
+
+    // prints statistics gathered by the simulation of the scene
+    virtual void showSimulationStatus();
+
+    // prints the memory used by the scene
+    virtual void showMemoryStatus();
 };
 
 #endif
\ No newline at end of file
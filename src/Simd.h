@@ -0,0 +1,35 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Helpers for the hand vectorized kernels. The kernels are compiled for their
+// instruction set with a target attribute, so the rest of the program does
+// not need any special compiler flag, and the best kernel supported by the
+// running CPU is chosen at runtime.
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define SIMD_X86_ENABLED
+    #include <immintrin.h>
+
+    #define SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+    #define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+inline bool isSse2Supported()
+{
+#ifdef SIMD_X86_ENABLED
+    return __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+inline bool isAvx2Supported()
+{
+#ifdef SIMD_X86_ENABLED
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+#endif
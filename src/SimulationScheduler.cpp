@@ -0,0 +1,123 @@
+#include "SimulationScheduler.h"
+#include "DrawingSettings.h"
+#include "SimulationSettings.h"
+#include "Profiler.h"
+#include "Tracer.h"
+
+#include <math.h>
+#include <iostream>
+
+// longest frame taken into account, so the simulation does not try to make up
+// for the program being paused by a debugger or window manager
+#define SCHEDULER_MAXIMUM_FRAME_TIME 0.25
+
+SimulationScheduler::SimulationScheduler() :
+    started(false),
+    accumulator(0.0),
+    lastSubsteps(0),
+    lastSimulationTime(0.0),
+    lastFrameLate(false),
+    renderStateDirty(true)
+{}
+
+void SimulationScheduler::advance(Scene* scene)
+{
+    PROFILE_SCOPE(PROFILE_SIMULATION);
+    TRACE_SCOPE("simulation");
+
+    SimulationSettings* simulationSettings = SimulationSettings::getInstance();
+
+    std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+    double frameTime = started ? std::chrono::duration<double>(frameStart - lastFrame).count() : 0.0;
+    lastFrame = frameStart;
+    started = true;
+
+    if(frameTime > SCHEDULER_MAXIMUM_FRAME_TIME)
+    {
+        frameTime = SCHEDULER_MAXIMUM_FRAME_TIME;
+    }
+
+    double timeStep = DrawingSettings::getInstance()->getTimeStep();
+
+    // paused
+    if(timeStep == 0.0)
+    {
+        accumulator = 0.0;
+        lastSubsteps = 0;
+        lastSimulationTime = 0.0;
+        lastFrameLate = false;
+
+        // the time spent paused is not simulated once running again
+        started = false;
+
+        // the drawn state only changes with the user interface
+        if(renderStateDirty)
+        {
+            scene->updateRenderState(1.0);
+            renderStateDirty = false;
+        }
+        return;
+    }
+
+    // drawn between 2 states, so it must be redrawn at the last one once paused
+    renderStateDirty = true;
+
+    accumulator += frameTime * simulationSettings->getSimulatedTimeRate();
+
+    int maximumSubsteps = simulationSettings->getMaximumSubsteps();
+    double frameBudget = simulationSettings->getFrameBudget() / 1000.0;
+    double elapsed = 0.0;
+    int substeps = 0;
+
+    while(accumulator >= timeStep && substeps < maximumSubsteps && elapsed < frameBudget)
+    {
+        scene->simulate();
+        accumulator -= timeStep;
+        substeps += 1;
+
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count();
+    }
+
+    lastFrameLate = accumulator >= timeStep;
+    if(lastFrameLate)
+    {
+        accumulator = fmod(accumulator, timeStep);
+    }
+
+    lastSubsteps = substeps;
+    lastSimulationTime = elapsed;
+
+    if(simulationSettings->isInterpolationEnabled())
+    {
+        scene->updateRenderState(accumulator / timeStep);
+    }
+    else
+    {
+        scene->updateRenderState(1.0);
+    }
+}
+
+int SimulationScheduler::getLastSubsteps()
+{
+    return lastSubsteps;
+}
+
+void SimulationScheduler::invalidateRenderState()
+{
+    renderStateDirty = true;
+}
+
+bool SimulationScheduler::isIdle()
+{
+    return DrawingSettings::getInstance()->getTimeStep() == 0.0 && !renderStateDirty;
+}
+
+void SimulationScheduler::showSchedulerStatus()
+{
+    std::cout << "scheduler status:" << std::endl;
+    std::cout << "  steps at last frame             : " << lastSubsteps << std::endl;
+    std::cout << "  simulation time at last frame   : " << 1000.0 * lastSimulationTime << " ms" << std::endl;
+    std::cout << "  simulation late at last frame   : " << (lastFrameLate ? "true" : "false") << std::endl;
+
+    std::cout << std::endl;
+}
@@ -0,0 +1,52 @@
+#ifndef SIMULATION_SCHEDULER_H
+#define SIMULATION_SCHEDULER_H
+
+#include <chrono>
+#include "Scene.h"
+
+// Decouples the simulation from the frame rate. The wall clock time elapsed
+// since the previous frame, scaled by the simulated time rate, is added to an
+// accumulator, and as many steps of the fixed time step as fit in it are
+// simulated before the frame is drawn. The steps of a frame are limited by a
+// maximum count and a wall clock budget: when the simulation can not keep up,
+// the late simulated time is dropped rather than caught up on later frames.
+//
+// The simulated time left in the accumulator gives how far the next state is,
+// which is used to draw the scene between its last 2 states.
+//
+// While paused, the scene is only prepared for drawing again after the user
+// interface changed something, so a paused simulation costs nothing.
+class SimulationScheduler
+{
+private:
+    std::chrono::steady_clock::time_point lastFrame;
+    bool started;
+
+    double accumulator;
+
+    int lastSubsteps;
+    double lastSimulationTime;
+    bool lastFrameLate;
+
+    // whether the scene must be prepared for drawing even though it is paused
+    bool renderStateDirty;
+
+public:
+    SimulationScheduler();
+
+    // simulates the steps of the frame, and prepares the scene for drawing
+    void advance(Scene* scene);
+
+    int getLastSubsteps();
+
+    // used by the user interface after it changed the scene or the settings
+    void invalidateRenderState();
+
+    // whether advance has nothing to do until the user interface changes
+    // something
+    bool isIdle();
+
+    void showSchedulerStatus();
+};
+
+#endif
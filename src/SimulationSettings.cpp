@@ -0,0 +1,360 @@
+#include "SimulationSettings.h"
+#include "Simd.h"
+#include <iostream>
+#include <thread>
+
+SimulationSettings* SimulationSettings::instance = 0;
+
+SimulationSettings* SimulationSettings::getInstance()
+{
+    if(instance == 0)
+    {
+        instance = new SimulationSettings();
+    }
+
+    return instance;
+}
+
+SimulationSettings::SimulationSettings() :
+    constraintSolverMode         (SEQUENTIAL_SOLVER),
+    numberThreads                (std::thread::hardware_concurrency()),
+    simdKernel                   (SCALAR_KERNEL),
+    selfCollisionMode            (SPATIAL_HASH_SELF_COLLISION),
+    skipTopologicalNeighbors     (false),
+    neighborListSkin             (0.5),
+    triangleSelfCollision        (false),
+    triangleCollisionThickness   (0.25),
+    triangleBvhRebuildInterval   (100),
+    constraintIterations         (1),
+    simulatedTimeRate            (0.1),
+    maximumSubsteps              (1000),
+    frameBudget                  (12.0),
+    interpolation                (true),
+    threadedSimulation           (true)
+{
+    // hardware_concurrency() returns 0 when it can not tell
+    if(numberThreads < 1)
+    {
+        numberThreads = 1;
+    }
+
+    // use the widest kernel the cpu supports
+    if(isSimdKernelSupported(AVX2_KERNEL))
+    {
+        simdKernel = AVX2_KERNEL;
+    }
+    else if(isSimdKernelSupported(SSE2_KERNEL))
+    {
+        simdKernel = SSE2_KERNEL;
+    }
+}
+
+ConstraintSolverMode SimulationSettings::getConstraintSolverMode()
+{
+    return constraintSolverMode;
+}
+
+void SimulationSettings::setConstraintSolverMode(ConstraintSolverMode mode)
+{
+    constraintSolverMode = mode;
+}
+
+void SimulationSettings::toggleConstraintSolverMode()
+{
+    if(constraintSolverMode == SEQUENTIAL_SOLVER)
+    {
+        constraintSolverMode = COLORED_SOLVER;
+    }
+    else
+    {
+        constraintSolverMode = SEQUENTIAL_SOLVER;
+    }
+}
+
+int SimulationSettings::getNumberThreads()
+{
+    return numberThreads;
+}
+
+void SimulationSettings::setNumberThreads(int threads)
+{
+    numberThreads = threads < 1 ? 1 : threads;
+}
+
+SimdKernel SimulationSettings::getSimdKernel()
+{
+    return simdKernel;
+}
+
+// falls back to the scalar kernel if the cpu does not support the requested one
+void SimulationSettings::setSimdKernel(SimdKernel kernel)
+{
+    if(isSimdKernelSupported(kernel))
+    {
+        simdKernel = kernel;
+    }
+    else
+    {
+        simdKernel = SCALAR_KERNEL;
+    }
+}
+
+// cycles through the kernels supported by the cpu
+void SimulationSettings::toggleSimdKernel()
+{
+    SimdKernel kernel = simdKernel;
+
+    do
+    {
+        kernel = (SimdKernel) ((kernel + 1) % (AVX2_KERNEL + 1));
+    }
+    while(!isSimdKernelSupported(kernel));
+
+    simdKernel = kernel;
+}
+
+bool SimulationSettings::isSimdKernelSupported(SimdKernel kernel)
+{
+    switch(kernel)
+    {
+        case SSE2_KERNEL:
+            return isSse2Supported();
+        case AVX2_KERNEL:
+            return isAvx2Supported();
+        default:
+            return true;
+    }
+}
+
+SelfCollisionMode SimulationSettings::getSelfCollisionMode()
+{
+    return selfCollisionMode;
+}
+
+void SimulationSettings::setSelfCollisionMode(SelfCollisionMode mode)
+{
+    selfCollisionMode = mode;
+}
+
+void SimulationSettings::toggleSelfCollisionMode()
+{
+    selfCollisionMode = (SelfCollisionMode) ((selfCollisionMode + 1) % (NEIGHBOR_LIST_SELF_COLLISION + 1));
+}
+
+// nodes next to each other in the cloth grid are kept apart by their
+// constraints, so they do not need to be tested against each other
+bool SimulationSettings::isSkipTopologicalNeighborsEnabled()
+{
+    return skipTopologicalNeighbors;
+}
+
+void SimulationSettings::setSkipTopologicalNeighborsEnabled(bool enabled)
+{
+    skipTopologicalNeighbors = enabled;
+}
+
+// margin added to the boundary radius when building the self-collision
+// neighbor lists, as a fraction of the boundary radius. A larger skin means
+// fewer rebuilds, but more candidates to test at each step
+double SimulationSettings::getNeighborListSkin()
+{
+    return neighborListSkin;
+}
+
+void SimulationSettings::setNeighborListSkin(double skin)
+{
+    neighborListSkin = skin < 0.0 ? 0.0 : skin;
+}
+
+// nodes tested against the triangles of their own cloth, in addition to the
+// other nodes, so the cloth can not pass through itself between two nodes
+bool SimulationSettings::isTriangleSelfCollisionEnabled()
+{
+    return triangleSelfCollision;
+}
+
+void SimulationSettings::setTriangleSelfCollisionEnabled(bool enabled)
+{
+    triangleSelfCollision = enabled;
+}
+
+void SimulationSettings::toggleTriangleSelfCollisionEnabled()
+{
+    triangleSelfCollision = !triangleSelfCollision;
+}
+
+// distance kept between a node and the triangles, as a fraction of the
+// boundary radius
+double SimulationSettings::getTriangleCollisionThickness()
+{
+    return triangleCollisionThickness;
+}
+
+void SimulationSettings::setTriangleCollisionThickness(double thickness)
+{
+    triangleCollisionThickness = thickness < 0.0 ? 0.0 : thickness;
+}
+
+// number of steps during which the triangle hierarchy is only refit
+int SimulationSettings::getTriangleBvhRebuildInterval()
+{
+    return triangleBvhRebuildInterval;
+}
+
+void SimulationSettings::setTriangleBvhRebuildInterval(int interval)
+{
+    triangleBvhRebuildInterval = interval < 1 ? 1 : interval;
+}
+
+// number of times the constraints are satisfied at each step
+int SimulationSettings::getConstraintIterations()
+{
+    return constraintIterations;
+}
+
+void SimulationSettings::setConstraintIterations(int iterations)
+{
+    constraintIterations = iterations < 1 ? 1 : iterations;
+}
+
+// simulated seconds per second of wall clock time
+double SimulationSettings::getSimulatedTimeRate()
+{
+    return simulatedTimeRate;
+}
+
+void SimulationSettings::setSimulatedTimeRate(double rate)
+{
+    simulatedTimeRate = rate < 0.0 ? 0.0 : rate;
+}
+
+// most steps simulated for a single rendered frame
+int SimulationSettings::getMaximumSubsteps()
+{
+    return maximumSubsteps;
+}
+
+void SimulationSettings::setMaximumSubsteps(int substeps)
+{
+    maximumSubsteps = substeps < 1 ? 1 : substeps;
+}
+
+// most wall clock time, in milliseconds, spent simulating for a single
+// rendered frame
+double SimulationSettings::getFrameBudget()
+{
+    return frameBudget;
+}
+
+void SimulationSettings::setFrameBudget(double budget)
+{
+    frameBudget = budget < 0.0 ? 0.0 : budget;
+}
+
+// draws the cloth between its last 2 simulated states, depending on how much
+// simulated time is left over for the next step, instead of at the last one
+bool SimulationSettings::isInterpolationEnabled()
+{
+    return interpolation;
+}
+
+void SimulationSettings::setInterpolationEnabled(bool enabled)
+{
+    interpolation = enabled;
+}
+
+void SimulationSettings::toggleInterpolationEnabled()
+{
+    interpolation = !interpolation;
+}
+
+// simulates the scene on its own thread instead of between the frames drawn
+// by the user interface. Only read when the scene is created
+bool SimulationSettings::isThreadedSimulationEnabled()
+{
+    return threadedSimulation;
+}
+
+void SimulationSettings::setThreadedSimulationEnabled(bool enabled)
+{
+    threadedSimulation = enabled;
+}
+
+void SimulationSettings::showSimulationStatus()
+{
+    std::cout << "simulation status:" << std::endl;
+    std::cout << "  constraint solver               : " << getConstraintSolverModeName(constraintSolverMode) << std::endl;
+    std::cout << "  threads                         : " << numberThreads << std::endl;
+    std::cout << "  simd kernel                     : " << getSimdKernelName(simdKernel) << std::endl;
+    std::cout << "  self collision                  : " << getSelfCollisionModeName(selfCollisionMode) << std::endl;
+    std::cout << "  skip topological neighbors      : " << isEnabled(skipTopologicalNeighbors) << std::endl;
+    std::cout << "  neighbor list skin              : " << neighborListSkin << std::endl;
+    std::cout << "  triangle self collision         : " << isEnabled(triangleSelfCollision) << std::endl;
+    std::cout << "  triangle collision thickness    : " << triangleCollisionThickness << std::endl;
+    std::cout << "  triangle bvh rebuild interval   : " << triangleBvhRebuildInterval << std::endl;
+    std::cout << "  constraint iterations           : " << constraintIterations << std::endl;
+    std::cout << "  simulated time rate             : " << simulatedTimeRate << std::endl;
+    std::cout << "  maximum substeps per frame      : " << maximumSubsteps << std::endl;
+    std::cout << "  frame budget                    : " << frameBudget << " ms" << std::endl;
+    std::cout << "  interpolation                   : " << isEnabled(interpolation) << std::endl;
+    std::cout << "  threaded simulation             : " << isEnabled(threadedSimulation) << std::endl;
+
+    std::cout << std::endl;
+}
+
+std::string SimulationSettings::getConstraintSolverModeName(ConstraintSolverMode mode)
+{
+    switch(mode)
+    {
+        case SEQUENTIAL_SOLVER:
+            return "sequential";
+        case COLORED_SOLVER:
+            return "colored";
+        default:
+            return "unknown";
+    }
+}
+
+
+std::string SimulationSettings::getSimdKernelName(SimdKernel kernel)
+{
+    switch(kernel)
+    {
+        case SCALAR_KERNEL:
+            return "scalar";
+        case SSE2_KERNEL:
+            return "sse2";
+        case AVX2_KERNEL:
+            return "avx2";
+        default:
+            return "unknown";
+    }
+}
+
+std::string SimulationSettings::getSelfCollisionModeName(SelfCollisionMode mode)
+{
+    switch(mode)
+    {
+        case BRUTE_FORCE_SELF_COLLISION:
+            return "brute force";
+        case SPATIAL_HASH_SELF_COLLISION:
+            return "spatial hash";
+        case NEIGHBOR_LIST_SELF_COLLISION:
+            return "neighbor list";
+        default:
+            return "unknown";
+    }
+}
+
+// prints "true" if controlVariableEnabled is true, and "false" otherwise
+std::string SimulationSettings::isEnabled(bool controlVariableEnabled)
+{
+    if(controlVariableEnabled)
+    {
+        return "true";
+    }
+    else
+    {
+        return "false";
+    }
+}
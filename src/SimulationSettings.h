@@ -0,0 +1,125 @@
+#ifndef SIMULATION_SETTINGS_H
+#define SIMULATION_SETTINGS_H
+
+#include <string>
+
+enum ConstraintSolverMode
+{
+    // single Gauss-Seidel sweep over the constraint table, in creation order
+    SEQUENTIAL_SOLVER,
+
+    // constraints grouped into batches of independent constraints, each
+    // batch being solved in parallel
+    COLORED_SOLVER
+};
+
+// how nodes of a cloth are found when testing them against each other
+enum SelfCollisionMode
+{
+    // every node against every other node
+    BRUTE_FORCE_SELF_COLLISION,
+
+    // only nodes in neighboring cells of a spatial hash grid. Pushes the nodes
+    // exactly like the brute force test
+    SPATIAL_HASH_SELF_COLLISION,
+
+    // only nodes in a cached list of candidates, rebuilt with the spatial
+    // hash grid when a node has moved further than half the skin margin
+    NEIGHBOR_LIST_SELF_COLLISION
+};
+
+// instruction set used by the vectorized loops (integration, and the batches
+// of the colored constraint solver)
+enum SimdKernel
+{
+    SCALAR_KERNEL,
+    SSE2_KERNEL,
+    AVX2_KERNEL
+};
+
+class SimulationSettings
+{
+private:
+    static SimulationSettings* instance;
+
+    ConstraintSolverMode constraintSolverMode;
+    int numberThreads;
+    SimdKernel simdKernel;
+    SelfCollisionMode selfCollisionMode;
+    bool skipTopologicalNeighbors;
+    double neighborListSkin;
+    bool triangleSelfCollision;
+    double triangleCollisionThickness;
+    int triangleBvhRebuildInterval;
+    int constraintIterations;
+    double simulatedTimeRate;
+    int maximumSubsteps;
+    double frameBudget;
+    bool interpolation;
+    bool threadedSimulation;
+
+protected:
+    SimulationSettings();
+
+public:
+    static SimulationSettings* getInstance();
+
+    ConstraintSolverMode getConstraintSolverMode();
+    void setConstraintSolverMode(ConstraintSolverMode mode);
+    void toggleConstraintSolverMode();
+
+    int getNumberThreads();
+    void setNumberThreads(int threads);
+
+    SimdKernel getSimdKernel();
+    void setSimdKernel(SimdKernel kernel);
+    void toggleSimdKernel();
+    bool isSimdKernelSupported(SimdKernel kernel);
+
+    SelfCollisionMode getSelfCollisionMode();
+    void setSelfCollisionMode(SelfCollisionMode mode);
+    void toggleSelfCollisionMode();
+
+    bool isSkipTopologicalNeighborsEnabled();
+    void setSkipTopologicalNeighborsEnabled(bool enabled);
+
+    double getNeighborListSkin();
+    void setNeighborListSkin(double skin);
+
+    bool isTriangleSelfCollisionEnabled();
+    void setTriangleSelfCollisionEnabled(bool enabled);
+    void toggleTriangleSelfCollisionEnabled();
+
+    double getTriangleCollisionThickness();
+    void setTriangleCollisionThickness(double thickness);
+
+    int getTriangleBvhRebuildInterval();
+    void setTriangleBvhRebuildInterval(int interval);
+
+    int getConstraintIterations();
+    void setConstraintIterations(int iterations);
+
+    double getSimulatedTimeRate();
+    void setSimulatedTimeRate(double rate);
+
+    int getMaximumSubsteps();
+    void setMaximumSubsteps(int substeps);
+
+    double getFrameBudget();
+    void setFrameBudget(double budget);
+
+    bool isInterpolationEnabled();
+    void setInterpolationEnabled(bool enabled);
+    void toggleInterpolationEnabled();
+
+    bool isThreadedSimulationEnabled();
+    void setThreadedSimulationEnabled(bool enabled);
+
+    void showSimulationStatus();
+    std::string getConstraintSolverModeName(ConstraintSolverMode mode);
+    std::string getSimdKernelName(SimdKernel kernel);
+    std::string getSelfCollisionModeName(SelfCollisionMode mode);
+    std::string isEnabled(bool controlVariableEnabled);
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "SpatialHashGrid.h"
+
+#include <math.h>
+
+SpatialHashGrid::SpatialHashGrid() :
+    cellSize(1.0),
+    inverseCellSize(1.0),
+    bucketMask(0)
+{}
+
+void SpatialHashGrid::build(ParticleStore* particles, double size)
+{
+    int numberParticles = particles->getNumberParticles();
+
+    cellSize = size;
+    inverseCellSize = 1.0 / size;
+
+    // about two buckets per node keeps collisions between cells rare
+    int numberBuckets = 1;
+    while(numberBuckets < 2 * numberParticles)
+    {
+        numberBuckets *= 2;
+    }
+    bucketMask = numberBuckets - 1;
+
+    bucketHead.assign(numberBuckets, -1);
+    nextNode.assign(numberParticles, -1);
+    previousNode.assign(numberParticles, -1);
+    nodeBucket.assign(numberParticles, -1);
+
+    for(int i = 0; i < numberParticles; i += 1)
+    {
+        insertNode(i, getBucket(particles->positionX[i], particles->positionY[i], particles->positionZ[i]));
+    }
+}
+
+double SpatialHashGrid::getCellSize()
+{
+    return cellSize;
+}
+
+int SpatialHashGrid::getBucket(double x, double y, double z)
+{
+    return hashCell((long long) floor(x * inverseCellSize),
+                    (long long) floor(y * inverseCellSize),
+                    (long long) floor(z * inverseCellSize));
+}
+
+int SpatialHashGrid::hashCell(long long cellX, long long cellY, long long cellZ)
+{
+    unsigned long long hash = (cellX * 73856093LL) ^ (cellY * 19349663LL) ^ (cellZ * 83492791LL);
+
+    return (int) (hash & bucketMask);
+}
+
+void SpatialHashGrid::insertNode(int node, int bucket)
+{
+    int head = bucketHead[bucket];
+
+    nextNode[node] = head;
+    previousNode[node] = -1;
+
+    if(head != -1)
+    {
+        previousNode[head] = node;
+    }
+
+    bucketHead[bucket] = node;
+    nodeBucket[node] = bucket;
+}
+
+void SpatialHashGrid::removeNode(int node)
+{
+    int previous = previousNode[node];
+    int next = nextNode[node];
+
+    if(previous != -1)
+    {
+        nextNode[previous] = next;
+    }
+    else
+    {
+        bucketHead[nodeBucket[node]] = next;
+    }
+
+    if(next != -1)
+    {
+        previousNode[next] = previous;
+    }
+}
+
+void SpatialHashGrid::updateNode(int node, double x, double y, double z)
+{
+    int bucket = getBucket(x, y, z);
+
+    if(bucket != nodeBucket[node])
+    {
+        removeNode(node);
+        insertNode(node, bucket);
+    }
+}
+
+int SpatialHashGrid::getNeighborBuckets(double x, double y, double z, int* buckets)
+{
+    long long cellX = (long long) floor(x * inverseCellSize);
+    long long cellY = (long long) floor(y * inverseCellSize);
+    long long cellZ = (long long) floor(z * inverseCellSize);
+
+    int numberBuckets = 0;
+
+    for(int dx = -1; dx <= 1; dx += 1)
+    {
+        for(int dy = -1; dy <= 1; dy += 1)
+        {
+            for(int dz = -1; dz <= 1; dz += 1)
+            {
+                int bucket = hashCell(cellX + dx, cellY + dy, cellZ + dz);
+
+                // several cells can hash to the same bucket, which must only
+                // be visited once
+                bool visited = false;
+                for(int b = 0; b < numberBuckets && !visited; b += 1)
+                {
+                    visited = buckets[b] == bucket;
+                }
+
+                if(!visited)
+                {
+                    buckets[numberBuckets] = bucket;
+                    numberBuckets += 1;
+                }
+            }
+        }
+    }
+
+    return numberBuckets;
+}
+
+long long SpatialHashGrid::getMemorySize()
+{
+    return (bucketHead.capacity() + nextNode.capacity() + previousNode.capacity() + nodeBucket.capacity()) * sizeof(int);
+}
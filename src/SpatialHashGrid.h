@@ -0,0 +1,59 @@
+#ifndef SPATIAL_HASH_GRID_H
+#define SPATIAL_HASH_GRID_H
+
+#include <vector>
+#include "ParticleStore.h"
+
+// Uniform grid over the nodes of a particle store, hashed into a fixed number
+// of buckets. Each bucket holds a doubly linked list of the nodes whose cell
+// hashes to it, so a node can be moved to another bucket in constant time.
+// Several cells may share a bucket, so the nodes found through a bucket still
+// have to be tested.
+class SpatialHashGrid
+{
+private:
+    double cellSize;
+    double inverseCellSize;
+    int bucketMask;
+
+    std::vector<int> bucketHead;
+    std::vector<int> nextNode;
+    std::vector<int> previousNode;
+    std::vector<int> nodeBucket;
+
+    int hashCell(long long cellX, long long cellY, long long cellZ);
+    void insertNode(int node, int bucket);
+    void removeNode(int node);
+
+public:
+    SpatialHashGrid();
+
+    // puts every node of the store in the grid, with cells of the given size
+    void build(ParticleStore* particles, double size);
+
+    double getCellSize();
+    // bytes of the arrays
+    long long getMemorySize();
+
+    int getBucket(double x, double y, double z);
+
+    // moves the node to the bucket matching its new position
+    void updateNode(int node, double x, double y, double z);
+
+    // fills buckets with the distinct buckets of the 27 cells around the cell
+    // containing (x, y, z), and returns how many there are
+    int getNeighborBuckets(double x, double y, double z, int* buckets);
+
+    // iteration over the nodes of a bucket, -1 marks the end of the list
+    int getFirstNode(int bucket)
+    {
+        return bucketHead[bucket];
+    }
+
+    int getNextNode(int node)
+    {
+        return nextNode[node];
+    }
+};
+
+#endif
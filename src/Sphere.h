@@ -2,7 +2,6 @@
 #define SPHERE_H
 
 #include "Vector3.h"
-#include "Node.h"
 
 class Sphere
 {
@@ -14,9 +13,6 @@ public:
     Sphere(Vector3 c, float r);
     Vector3 getCenter();
     float getRadius();
-    void draw();
-    void handleNodeIntersection(Node* node, bool isClothSelfIntersectionSphere);
-    bool willHitSphere(Node* node);
     void setCenter(Vector3 c);
     void translate(Vector3 direction);
 };
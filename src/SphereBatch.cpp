@@ -0,0 +1,55 @@
+#include "SphereBatch.h"
+
+#ifndef HEADLESS
+// OpenGL imports
+#include <GL/glut.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
+
+SphereBatch::SphereBatch(int slices, int stacks) :
+    mesh(SphereMesh::getMesh(slices, stacks))
+{}
+
+void SphereBatch::clear()
+{
+    spheres.clear();
+}
+
+void SphereBatch::addSphere(Vector3 center, double radius)
+{
+    spheres.push_back(center.x);
+    spheres.push_back(center.y);
+    spheres.push_back(center.z);
+    spheres.push_back(radius);
+}
+
+int SphereBatch::getNumberSpheres()
+{
+    return spheres.size() / 4;
+}
+
+void SphereBatch::draw()
+{
+#ifndef HEADLESS
+    if(spheres.empty())
+    {
+        return;
+    }
+
+    mesh->bind();
+
+    for(unsigned int i = 0; i < spheres.size(); i += 4)
+    {
+        float* sphere = &spheres[i];
+
+        glPushMatrix();
+            glTranslatef(sphere[0], sphere[1], sphere[2]);
+            glScalef(sphere[3], sphere[3], sphere[3]);
+            mesh->draw();
+        glPopMatrix();
+    }
+
+    mesh->unbind();
+#endif
+}
@@ -0,0 +1,36 @@
+#ifndef SPHERE_BATCH_H
+#define SPHERE_BATCH_H
+
+#include <vector>
+#include "Vector3.h"
+#include "SphereMesh.h"
+
+// Spheres of one kind (scene colliders, node markers, arrow tips, ...),
+// gathered over a frame. Only the center and radius of each sphere are
+// stored: every sphere is drawn from the same cached mesh, bound once for the
+// whole batch, by translating and scaling the modelview matrix. The state it
+// is drawn with is set by the RenderPass it is submitted to.
+class SphereBatch
+{
+private:
+    SphereMesh* mesh;
+
+    // 4 floats per sphere: center, then radius
+    std::vector<float> spheres;
+
+public:
+    SphereBatch(int slices, int stacks);
+
+    // empties the batch, keeping its memory for the next frame
+    void clear();
+
+    void addSphere(Vector3 center, double radius);
+
+    int getNumberSpheres();
+
+    // draws the spheres with the current state. The vertex and normal arrays
+    // must be enabled, and normals rescaled if the spheres are lit
+    void draw();
+};
+
+#endif
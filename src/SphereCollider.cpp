@@ -0,0 +1,270 @@
+#include "SphereCollider.h"
+#include "Simd.h"
+
+#include <math.h>
+
+// smallest number of blocks of nodes handed to a thread at once
+#define SPHERE_COLLISION_GRAIN 128
+
+SphereCollider::SphereCollider(ParticleStore* store) :
+    particles(store),
+    spheres(0),
+    grid(0),
+    kernel(SCALAR_KERNEL),
+    grain(SPHERE_COLLISION_GRAIN)
+{}
+
+void SphereCollider::generateContacts(std::vector<Sphere>* sphereSet, SphereGrid* sphereGrid, std::vector<Contact>* contacts)
+{
+    WorkerPool* workerPool = WorkerPool::getInstance();
+
+    spheres = sphereSet;
+    grid = sphereGrid;
+    kernel = SimulationSettings::getInstance()->getSimdKernel();
+
+    int numberBlocks = particles->getPaddedNumberParticles() / PARTICLE_STORE_PADDING;
+
+    grain = numberBlocks / (4 * workerPool->getNumberThreads());
+    if(grain < SPHERE_COLLISION_GRAIN)
+    {
+        grain = SPHERE_COLLISION_GRAIN;
+    }
+
+    int numberChunks = (numberBlocks + grain - 1) / grain;
+
+    if((int) chunkContacts.size() < numberChunks)
+    {
+        chunkContacts.resize(numberChunks);
+        chunkCandidates.resize(numberChunks);
+    }
+
+    // a few contacts per node of the chunk, and every sphere as a candidate, so
+    // the chunks do not grow with the contacts. Does nothing once the chunks
+    // are large enough. The chunks are emptied here rather than when they are
+    // run, since the worker pool runs all the blocks as a single chunk when it
+    // does not hand them to the workers
+    for(int c = 0; c < numberChunks; c += 1)
+    {
+        chunkContacts[c].clear();
+        chunkContacts[c].reserve(grain * PARTICLE_STORE_PADDING * CONTACTS_PER_NODE);
+        chunkCandidates[c].reserve(spheres->size());
+    }
+
+    workerPool->run(this, numberBlocks, grain);
+
+    for(int c = 0; c < numberChunks; c += 1)
+    {
+        contacts->insert(contacts->end(), chunkContacts[c].begin(), chunkContacts[c].end());
+    }
+}
+
+void SphereCollider::execute(int begin, int end)
+{
+    // the worker pool always starts chunks on a multiple of the grain
+    int chunk = begin / grain;
+    std::vector<Contact>* contacts = &chunkContacts[chunk];
+
+    // the padding entries are not nodes, and must not get contacts
+    int firstNode = begin * PARTICLE_STORE_PADDING;
+    int lastNode = end * PARTICLE_STORE_PADDING;
+
+    if(lastNode > particles->getNumberParticles())
+    {
+        lastNode = particles->getNumberParticles();
+    }
+
+    if(grid != 0)
+    {
+        collideWithGrid(firstNode, lastNode, contacts, &chunkCandidates[chunk]);
+        return;
+    }
+
+    for(unsigned int s = 0; s < spheres->size(); s += 1)
+    {
+        switch(kernel)
+        {
+            case AVX2_KERNEL:
+                collideAvx2(s, firstNode, lastNode, contacts);
+                break;
+            case SSE2_KERNEL:
+                collideSse2(s, firstNode, lastNode, contacts);
+                break;
+            default:
+                collideScalar(s, firstNode, lastNode, contacts);
+                break;
+        }
+    }
+}
+
+// the kernels only find which nodes are inside the sphere. The contacts are
+// rare, so they are computed one at a time here
+void SphereCollider::addContact(int node, int sphere, std::vector<Contact>* contacts)
+{
+    Vector3 center = (*spheres)[sphere].getCenter();
+    double radius = (*spheres)[sphere].getRadius();
+
+    double toNodeX = particles->positionX[node] - center.x;
+    double toNodeY = particles->positionY[node] - center.y;
+    double toNodeZ = particles->positionZ[node] - center.z;
+    double length = sqrt(toNodeX * toNodeX + toNodeY * toNodeY + toNodeZ * toNodeZ);
+
+    // a node exactly on the center can not be pushed in any direction
+    if(length == 0.0)
+    {
+        return;
+    }
+
+    contacts->push_back(Contact(node, sphere, toNodeX / length, toNodeY / length, toNodeZ / length, radius - length));
+}
+
+void SphereCollider::collideWithGrid(int begin, int end, std::vector<Contact>* contacts, std::vector<int>* candidates)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    for(int i = begin; i < end; i += 1)
+    {
+        grid->getCandidates(positionX[i], positionY[i], positionZ[i], candidates);
+
+        // the candidates are the spheres containing the node
+        for(std::vector<int>::iterator it = candidates->begin();
+            it != candidates->end();
+            ++it)
+        {
+            addContact(i, *it, contacts);
+        }
+    }
+}
+
+void SphereCollider::collideScalar(int sphere, int begin, int end, std::vector<Contact>* contacts)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    Vector3 center = (*spheres)[sphere].getCenter();
+    double radius = (*spheres)[sphere].getRadius();
+    double radiusSquared = radius * radius;
+
+    for(int i = begin; i < end; i += 1)
+    {
+        double toNodeX = positionX[i] - center.x;
+        double toNodeY = positionY[i] - center.y;
+        double toNodeZ = positionZ[i] - center.z;
+
+        if(toNodeX * toNodeX + toNodeY * toNodeY + toNodeZ * toNodeZ < radiusSquared)
+        {
+            addContact(i, sphere, contacts);
+        }
+    }
+}
+
+#ifdef SIMD_X86_ENABLED
+
+// the vectorized kernels compute the same squared distances as the scalar
+// one, so all kernels find the same contacts, in the same order
+
+SIMD_TARGET_SSE2
+void SphereCollider::collideSse2(int sphere, int begin, int end, std::vector<Contact>* contacts)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    Vector3 center = (*spheres)[sphere].getCenter();
+    double radius = (*spheres)[sphere].getRadius();
+
+    const __m128d cx = _mm_set1_pd(center.x);
+    const __m128d cy = _mm_set1_pd(center.y);
+    const __m128d cz = _mm_set1_pd(center.z);
+    const __m128d radiusSquared = _mm_set1_pd(radius * radius);
+
+    int i = begin;
+
+    for(; i + 2 <= end; i += 2)
+    {
+        __m128d toNodeX = _mm_sub_pd(_mm_load_pd(&positionX[i]), cx);
+        __m128d toNodeY = _mm_sub_pd(_mm_load_pd(&positionY[i]), cy);
+        __m128d toNodeZ = _mm_sub_pd(_mm_load_pd(&positionZ[i]), cz);
+        __m128d lengthSquared = _mm_add_pd(_mm_add_pd(_mm_mul_pd(toNodeX, toNodeX), _mm_mul_pd(toNodeY, toNodeY)), _mm_mul_pd(toNodeZ, toNodeZ));
+
+        int insideMask = _mm_movemask_pd(_mm_cmplt_pd(lengthSquared, radiusSquared));
+
+        for(int lane = 0; insideMask != 0; lane += 1, insideMask >>= 1)
+        {
+            if(insideMask & 1)
+            {
+                addContact(i + lane, sphere, contacts);
+            }
+        }
+    }
+
+    collideScalar(sphere, i, end, contacts);
+}
+
+SIMD_TARGET_AVX2
+void SphereCollider::collideAvx2(int sphere, int begin, int end, std::vector<Contact>* contacts)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    Vector3 center = (*spheres)[sphere].getCenter();
+    double radius = (*spheres)[sphere].getRadius();
+
+    const __m256d cx = _mm256_set1_pd(center.x);
+    const __m256d cy = _mm256_set1_pd(center.y);
+    const __m256d cz = _mm256_set1_pd(center.z);
+    const __m256d radiusSquared = _mm256_set1_pd(radius * radius);
+
+    int i = begin;
+
+    for(; i + 4 <= end; i += 4)
+    {
+        __m256d toNodeX = _mm256_sub_pd(_mm256_load_pd(&positionX[i]), cx);
+        __m256d toNodeY = _mm256_sub_pd(_mm256_load_pd(&positionY[i]), cy);
+        __m256d toNodeZ = _mm256_sub_pd(_mm256_load_pd(&positionZ[i]), cz);
+        __m256d lengthSquared = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(toNodeX, toNodeX), _mm256_mul_pd(toNodeY, toNodeY)), _mm256_mul_pd(toNodeZ, toNodeZ));
+
+        int insideMask = _mm256_movemask_pd(_mm256_cmp_pd(lengthSquared, radiusSquared, _CMP_LT_OQ));
+
+        for(int lane = 0; insideMask != 0; lane += 1, insideMask >>= 1)
+        {
+            if(insideMask & 1)
+            {
+                addContact(i + lane, sphere, contacts);
+            }
+        }
+    }
+
+    collideScalar(sphere, i, end, contacts);
+}
+
+#else
+
+void SphereCollider::collideSse2(int sphere, int begin, int end, std::vector<Contact>* contacts)
+{
+    collideScalar(sphere, begin, end, contacts);
+}
+
+void SphereCollider::collideAvx2(int sphere, int begin, int end, std::vector<Contact>* contacts)
+{
+    collideScalar(sphere, begin, end, contacts);
+}
+
+#endif
+
+long long SphereCollider::getMemorySize()
+{
+    long long bytes = chunkContacts.capacity() * sizeof(std::vector<Contact>) +
+                      chunkCandidates.capacity() * sizeof(std::vector<int>);
+
+    for(unsigned int c = 0; c < chunkContacts.size(); c += 1)
+    {
+        bytes += chunkContacts[c].capacity() * sizeof(Contact) +
+                 chunkCandidates[c].capacity() * sizeof(int);
+    }
+
+    return bytes;
+}
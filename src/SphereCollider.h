@@ -0,0 +1,56 @@
+#ifndef SPHERE_COLLIDER_H
+#define SPHERE_COLLIDER_H
+
+#include <vector>
+#include "ParticleStore.h"
+#include "WorkerPool.h"
+#include "SimulationSettings.h"
+#include "Sphere.h"
+#include "SphereGrid.h"
+#include "Contact.h"
+
+// Finds the nodes of a particle store which are inside a set of spheres, and
+// appends one contact per (node, sphere) pair to a contact list. Nothing is
+// written to the nodes themselves. The nodes are split across the worker pool
+// in blocks. Small sets of spheres are tested against every block with the
+// vectorized kernel selected in SimulationSettings, large sets go through a
+// sphere grid, one node at a time.
+//
+// Each chunk of blocks handed to a thread fills its own list, and the lists
+// are joined in chunk order, so the contacts always come out in the same
+// order whatever the number of threads.
+class SphereCollider : public ParallelTask
+{
+private:
+    ParticleStore* particles;
+
+    // parameters of the generation being run by execute()
+    std::vector<Sphere>* spheres;
+    SphereGrid* grid;
+    SimdKernel kernel;
+    int grain;
+
+    std::vector< std::vector<Contact> > chunkContacts;
+    std::vector< std::vector<int> > chunkCandidates;
+
+    void collideScalar(int sphere, int begin, int end, std::vector<Contact>* contacts);
+    void collideSse2(int sphere, int begin, int end, std::vector<Contact>* contacts);
+    void collideAvx2(int sphere, int begin, int end, std::vector<Contact>* contacts);
+    void collideWithGrid(int begin, int end, std::vector<Contact>* contacts, std::vector<int>* candidates);
+    void addContact(int node, int sphere, std::vector<Contact>* contacts);
+
+public:
+    SphereCollider(ParticleStore* store);
+
+    // appends the contacts between the nodes and the spheres to contacts.
+    // sphereGrid may be 0, otherwise it must be up to date with the spheres
+    void generateContacts(std::vector<Sphere>* sphereSet, SphereGrid* sphereGrid, std::vector<Contact>* contacts);
+
+    // bytes of the buffers of the chunks
+    long long getMemorySize();
+
+    // tests blocks [begin, end) of PARTICLE_STORE_PADDING nodes
+    void execute(int begin, int end);
+};
+
+#endif
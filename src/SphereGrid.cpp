@@ -0,0 +1,202 @@
+#include "SphereGrid.h"
+
+#include <math.h>
+#include <algorithm>
+
+SphereGrid::SphereGrid() :
+    cellSize(1.0),
+    inverseCellSize(1.0),
+    bucketMask(0),
+    maximumRadius(0.0),
+    driftTolerance(0.0),
+    numberBuilds(0)
+{}
+
+void SphereGrid::update(std::vector<Sphere>* spheres)
+{
+    int numberSpheres = spheres->size();
+    bool changed = numberSpheres != (int) centers.size();
+
+    for(int s = 0; s < numberSpheres && !changed; s += 1)
+    {
+        changed = (*spheres)[s].getRadius() != radii[s];
+    }
+
+    // the translation of the whole set is taken from its first sphere, and
+    // every other one must have followed it
+    Vector3 translation;
+    if(!changed && numberSpheres > 0)
+    {
+        translation = (*spheres)[0].getCenter() - builtCenters[0];
+    }
+
+    for(int s = 0; s < numberSpheres && !changed; s += 1)
+    {
+        Vector3 drift = (*spheres)[s].getCenter() - translation - builtCenters[s];
+        changed = fabs(drift.x) > driftTolerance || fabs(drift.y) > driftTolerance || fabs(drift.z) > driftTolerance;
+    }
+
+    if(changed)
+    {
+        build(spheres);
+        return;
+    }
+
+    origin = translation;
+    for(int s = 0; s < numberSpheres; s += 1)
+    {
+        centers[s] = (*spheres)[s].getCenter();
+    }
+}
+
+void SphereGrid::build(std::vector<Sphere>* spheres)
+{
+    int numberSpheres = spheres->size();
+
+    builtCenters.resize(numberSpheres);
+    centers.resize(numberSpheres);
+    radii.resize(numberSpheres);
+    origin = Vector3(0.0, 0.0, 0.0);
+    maximumRadius = 0.0;
+
+    for(int s = 0; s < numberSpheres; s += 1)
+    {
+        builtCenters[s] = (*spheres)[s].getCenter();
+        centers[s] = builtCenters[s];
+        radii[s] = (*spheres)[s].getRadius();
+        maximumRadius = std::max(maximumRadius, radii[s]);
+    }
+
+    // a point inside a sphere is at most one maximum radius away from its
+    // center, plus the drift tolerance from its built center. With cells of 2
+    // such distances, the centers to test are in the cell of the point or in
+    // the neighbor cell it is closest to, along each axis
+    driftTolerance = SPHERE_GRID_DRIFT_TOLERANCE * maximumRadius;
+    cellSize = std::max(2.0 * (maximumRadius + driftTolerance), 1e-6);
+    inverseCellSize = 1.0 / cellSize;
+
+    int numberBuckets = 1;
+    while(numberBuckets < 2 * numberSpheres)
+    {
+        numberBuckets *= 2;
+    }
+    bucketMask = numberBuckets - 1;
+
+    // counting sort of the spheres by bucket, which keeps the spheres of a
+    // bucket in increasing order
+    bucketStart.assign(numberBuckets + 1, 0);
+    sphereBucket.resize(numberSpheres);
+
+    for(int s = 0; s < numberSpheres; s += 1)
+    {
+        sphereBucket[s] = getBucket(builtCenters[s].x, builtCenters[s].y, builtCenters[s].z);
+        bucketStart[sphereBucket[s] + 1] += 1;
+    }
+
+    for(int b = 0; b < numberBuckets; b += 1)
+    {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    sphereIndices.resize(numberSpheres);
+    bucketFill.assign(bucketStart.begin(), bucketStart.end() - 1);
+
+    for(int s = 0; s < numberSpheres; s += 1)
+    {
+        sphereIndices[bucketFill[sphereBucket[s]]] = s;
+        bucketFill[sphereBucket[s]] += 1;
+    }
+
+    numberBuilds += 1;
+}
+
+int SphereGrid::getBucket(double x, double y, double z)
+{
+    return hashCell((long long) floor(x * inverseCellSize),
+                    (long long) floor(y * inverseCellSize),
+                    (long long) floor(z * inverseCellSize));
+}
+
+int SphereGrid::hashCell(long long cellX, long long cellY, long long cellZ)
+{
+    unsigned long long hash = (cellX * 73856093LL) ^ (cellY * 19349663LL) ^ (cellZ * 83492791LL);
+
+    return (int) (hash & bucketMask);
+}
+
+void SphereGrid::getCandidates(double x, double y, double z, std::vector<int>* candidates)
+{
+    candidates->clear();
+
+    if(centers.empty())
+    {
+        return;
+    }
+
+    // the cells were laid out before the spheres moved by origin
+    double gridX = (x - origin.x) * inverseCellSize;
+    double gridY = (y - origin.y) * inverseCellSize;
+    double gridZ = (z - origin.z) * inverseCellSize;
+
+    long long cellX = (long long) floor(gridX);
+    long long cellY = (long long) floor(gridY);
+    long long cellZ = (long long) floor(gridZ);
+
+    // neighbor cell on the side of the point, along each axis
+    long long stepX = gridX - cellX < 0.5 ? -1 : 1;
+    long long stepY = gridY - cellY < 0.5 ? -1 : 1;
+    long long stepZ = gridZ - cellZ < 0.5 ? -1 : 1;
+
+    int buckets[8];
+    int numberBuckets = 0;
+
+    for(int c = 0; c < 8; c += 1)
+    {
+        int bucket = hashCell(cellX + (c & 1 ? stepX : 0),
+                              cellY + (c & 2 ? stepY : 0),
+                              cellZ + (c & 4 ? stepZ : 0));
+
+        // several cells can hash to the same bucket, which must only be
+        // visited once
+        bool visited = false;
+        for(int b = 0; b < numberBuckets && !visited; b += 1)
+        {
+            visited = buckets[b] == bucket;
+        }
+
+        if(!visited)
+        {
+            buckets[numberBuckets] = bucket;
+            numberBuckets += 1;
+        }
+    }
+
+    for(int b = 0; b < numberBuckets; b += 1)
+    {
+        for(int k = bucketStart[buckets[b]]; k < bucketStart[buckets[b] + 1]; k += 1)
+        {
+            int s = sphereIndices[k];
+
+            double toPointX = x - centers[s].x;
+            double toPointY = y - centers[s].y;
+            double toPointZ = z - centers[s].z;
+
+            if(toPointX * toPointX + toPointY * toPointY + toPointZ * toPointZ < radii[s] * radii[s])
+            {
+                candidates->push_back(s);
+            }
+        }
+    }
+}
+
+int SphereGrid::getNumberBuilds()
+{
+    return numberBuilds;
+}
+
+long long SphereGrid::getMemorySize()
+{
+    return (bucketStart.capacity() + sphereIndices.capacity() + sphereBucket.capacity() + bucketFill.capacity()) * sizeof(int) +
+           (builtCenters.capacity() + centers.capacity()) * sizeof(Vector3) +
+           radii.capacity() * sizeof(float);
+}
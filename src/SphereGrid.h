@@ -0,0 +1,68 @@
+#ifndef SPHERE_GRID_H
+#define SPHERE_GRID_H
+
+#include <vector>
+#include "Vector3.h"
+#include "Sphere.h"
+
+// smaller sets of spheres are simply tested against every node
+#define SPHERE_GRID_MINIMUM_SPHERES 16
+
+// how far, relative to the largest radius, a sphere may be from where the
+// translation of its set puts it before the grid is built again
+#define SPHERE_GRID_DRIFT_TOLERANCE 1e-6
+
+// Uniform grid over a set of spheres, hashed into a fixed number of buckets.
+// The spheres of each bucket are stored contiguously and in increasing order,
+// like a sorted list. The grid keeps a copy of the spheres it was built with,
+// and is only built again when one of them has moved on its own or changed
+// size. A set moved as a whole, like the boundaries following the body, only
+// shifts the origin of the grid, so static and rigidly moving sets are almost
+// free to update.
+class SphereGrid
+{
+private:
+    double cellSize;
+    double inverseCellSize;
+    int bucketMask;
+    float maximumRadius;
+
+    // spheres of bucket b are sphereIndices[bucketStart[b]] .. sphereIndices[bucketStart[b + 1] - 1]
+    std::vector<int> bucketStart;
+    std::vector<int> sphereIndices;
+    std::vector<int> sphereBucket;
+    std::vector<int> bucketFill;
+
+    // spheres the grid was built with, and the current centers, which are
+    // the built ones moved by origin up to the drift tolerance
+    std::vector<Vector3> builtCenters;
+    std::vector<Vector3> centers;
+    std::vector<float> radii;
+
+    Vector3 origin;
+    double driftTolerance;
+
+    int numberBuilds;
+
+    int hashCell(long long cellX, long long cellY, long long cellZ);
+    int getBucket(double x, double y, double z);
+    void build(std::vector<Sphere>* spheres);
+
+public:
+    SphereGrid();
+
+    // builds the grid again if the spheres differ from the last build by
+    // more than a translation
+    void update(std::vector<Sphere>* spheres);
+
+    // fills candidates with every sphere containing (x, y, z). The order only
+    // depends on the point and on the spheres
+    void getCandidates(double x, double y, double z, std::vector<int>* candidates);
+
+    int getNumberBuilds();
+
+    // bytes of the arrays
+    long long getMemorySize();
+};
+
+#endif
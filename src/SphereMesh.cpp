@@ -0,0 +1,121 @@
+#include "SphereMesh.h"
+
+#include <math.h>
+
+#ifndef HEADLESS
+// OpenGL imports. Buffer objects are part of OpenGL 1.5, which gl.h does not
+// declare without GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#include <GL/glut.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#include <GL/glext.h>
+#endif
+
+std::map< std::pair<int, int>, SphereMesh* > SphereMesh::meshes;
+
+SphereMesh* SphereMesh::getMesh(int slices, int stacks)
+{
+    std::pair<int, int> level(slices, stacks);
+    std::map< std::pair<int, int>, SphereMesh* >::iterator it = meshes.find(level);
+
+    if(it == meshes.end())
+    {
+        it = meshes.insert(std::make_pair(level, new SphereMesh(slices, stacks))).first;
+    }
+
+    return it->second;
+}
+
+// rings of slices + 1 vertices from the +z pole to the -z pole. The first and
+// last vertex of a ring are at the same place, so every quad between 2 rings
+// can be indexed the same way
+SphereMesh::SphereMesh(int slices, int stacks) :
+    vertexBuffer(0),
+    indexBuffer(0),
+    buffersCreated(false)
+{
+    double pi = 3.14159265358979323846;
+
+    for(int i = 0; i <= stacks; i += 1)
+    {
+        double phi = pi * i / stacks;
+
+        for(int j = 0; j <= slices; j += 1)
+        {
+            double theta = 2.0 * pi * j / slices;
+
+            vertices.push_back(cos(theta) * sin(phi));
+            vertices.push_back(sin(theta) * sin(phi));
+            vertices.push_back(cos(phi));
+        }
+    }
+
+    for(int i = 0; i < stacks; i += 1)
+    {
+        for(int j = 0; j < slices; j += 1)
+        {
+            unsigned int topLeft = i * (slices + 1) + j;
+            unsigned int bottomLeft = topLeft + slices + 1;
+
+            indices.push_back(topLeft);
+            indices.push_back(bottomLeft);
+            indices.push_back(bottomLeft + 1);
+
+            indices.push_back(topLeft);
+            indices.push_back(bottomLeft + 1);
+            indices.push_back(topLeft + 1);
+        }
+    }
+}
+
+void SphereMesh::createBuffers()
+{
+#ifndef HEADLESS
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &indexBuffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    buffersCreated = true;
+#endif
+}
+
+// on a unit sphere, a vertex is its own normal, so both arrays read the same
+// buffer
+void SphereMesh::bind()
+{
+#ifndef HEADLESS
+    if(!buffersCreated)
+    {
+        createBuffers();
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glVertexPointer(3, GL_FLOAT, 0, (const GLvoid*) 0);
+    glNormalPointer(GL_FLOAT, 0, (const GLvoid*) 0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+#endif
+}
+
+void SphereMesh::unbind()
+{
+#ifndef HEADLESS
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+void SphereMesh::draw()
+{
+#ifndef HEADLESS
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (const GLvoid*) 0);
+#endif
+}
@@ -0,0 +1,47 @@
+#ifndef SPHERE_MESH_H
+#define SPHERE_MESH_H
+
+#include <vector>
+#include <map>
+#include <utility>
+
+// Unit sphere centered on the origin, tessellated like glutSolidSphere. Each
+// tessellation level is generated once and shared, instead of being
+// recomputed every time a sphere is drawn. It is uploaded once to vertex
+// buffer objects, and every sphere drawn with it only changes the modelview
+// matrix.
+class SphereMesh
+{
+private:
+    static std::map< std::pair<int, int>, SphereMesh* > meshes;
+
+    // 3 floats per vertex. On a unit sphere, a vertex is its own normal
+    std::vector<float> vertices;
+
+    // 3 vertex indices per triangle
+    std::vector<unsigned int> indices;
+
+    // buffer names, created with the first sphere drawn because they need a
+    // current OpenGL context
+    unsigned int vertexBuffer;
+    unsigned int indexBuffer;
+    bool buffersCreated;
+
+    SphereMesh(int slices, int stacks);
+
+    void createBuffers();
+
+public:
+    // mesh with the given number of subdivisions around and along the z axis
+    static SphereMesh* getMesh(int slices, int stacks);
+
+    // points the vertex and normal arrays to the buffers of the mesh, which
+    // must be enabled, so it can be drawn any number of times
+    void bind();
+    void unbind();
+
+    // draws the bound mesh with the current state and modelview matrix
+    void draw();
+};
+
+#endif
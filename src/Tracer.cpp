@@ -0,0 +1,137 @@
+#include "Tracer.h"
+
+#ifdef ENABLE_TRACER
+
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+
+// ring of the calling thread, created the first time it records a span
+static thread_local TraceRing* threadRing = 0;
+
+Tracer* Tracer::instance = 0;
+bool Tracer::enabled = false;
+
+Tracer* Tracer::getInstance()
+{
+    if(instance == 0)
+    {
+        instance = new Tracer();
+    }
+
+    return instance;
+}
+
+Tracer::Tracer() :
+    start(std::chrono::steady_clock::now())
+{}
+
+void Tracer::enable(std::string file)
+{
+    path = file;
+
+    if(!enabled)
+    {
+        enabled = true;
+        atexit(writeTraceAtExit);
+    }
+}
+
+bool Tracer::isEnabled()
+{
+    return enabled;
+}
+
+double Tracer::now()
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+TraceRing* Tracer::getThreadRing()
+{
+    if(threadRing == 0)
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+
+        threadRing = new TraceRing(rings.size() + 1);
+        rings.push_back(threadRing);
+    }
+
+    return threadRing;
+}
+
+void Tracer::addSpan(const char* name, double begin, double end)
+{
+    TraceRing* ring = getThreadRing();
+    unsigned long count = ring->count.load(std::memory_order_relaxed);
+
+    TraceSpan* span = &ring->spans[count & (TRACER_RING_SIZE - 1)];
+    span->name = name;
+    span->begin = begin;
+    span->end = end;
+
+    ring->count.store(count + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(std::string name)
+{
+    getThreadRing()->threadName = name;
+}
+
+void Tracer::writeTrace()
+{
+    std::lock_guard<std::mutex> lock(ringsMutex);
+
+    std::ofstream file(path.c_str());
+    if(!file.is_open())
+    {
+        std::cerr << "can not open " << path << std::endl;
+        return;
+    }
+
+    file << "{\"traceEvents\":[" << std::endl;
+    file.setf(std::ios::fixed);
+    file.precision(3);
+
+    bool first = true;
+    int numberSpans = 0;
+
+    for(std::vector<TraceRing*>::iterator it = rings.begin(); it != rings.end(); ++it)
+    {
+        TraceRing* ring = *it;
+
+        if(!ring->threadName.empty())
+        {
+            file << (first ? "" : ",\n")
+                 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->threadId
+                 << ",\"args\":{\"name\":\"" << ring->threadName << "\"}}";
+            first = false;
+        }
+
+        // only the latest spans are still in the ring
+        unsigned long count = ring->count.load(std::memory_order_acquire);
+        unsigned long oldest = count > TRACER_RING_SIZE ? count - TRACER_RING_SIZE : 0;
+
+        for(unsigned long i = oldest; i < count; i += 1)
+        {
+            TraceSpan* span = &ring->spans[i & (TRACER_RING_SIZE - 1)];
+
+            file << (first ? "" : ",\n")
+                 << "{\"name\":\"" << span->name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadId
+                 << ",\"ts\":" << span->begin << ",\"dur\":" << span->end - span->begin << "}";
+            first = false;
+            numberSpans += 1;
+        }
+    }
+
+    file << std::endl << "]}" << std::endl;
+
+    std::cout << "trace of " << numberSpans << " spans written to " << path << std::endl;
+}
+
+void Tracer::writeTraceAtExit()
+{
+    getInstance()->writeTrace();
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+// Records a timeline of the simulation and drawing, to find stalls between
+// threads. TRACE_SCOPE records the begin and end of the enclosing block as a
+// span, in a ring buffer of the calling thread, so threads never wait on each
+// other while they record. When a ring is full, the oldest spans are
+// overwritten. The spans of all threads are written as a Chrome trace (JSON
+// trace event format), which chrome://tracing and Perfetto can open.
+//
+// Everything is compiled only when ENABLE_TRACER is defined. Otherwise
+// TRACE_SCOPE expands to nothing, and the code using the tracer directly must
+// be guarded by ENABLE_TRACER too.
+
+#ifdef ENABLE_TRACER
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// spans kept per thread, must be a power of 2
+#define TRACER_RING_SIZE 65536
+
+#define TRACE_SCOPE(name) TraceScope traceScope(name)
+#define TRACE_THREAD_NAME(name) if(Tracer::isEnabled()) Tracer::getInstance()->setThreadName(name)
+
+// span of a block, in microseconds since the tracer was created
+class TraceSpan
+{
+public:
+    const char* name;
+    double begin;
+    double end;
+};
+
+// spans of one thread. Only that thread writes to it
+class TraceRing
+{
+public:
+    int threadId;
+    std::string threadName;
+
+    TraceSpan spans[TRACER_RING_SIZE];
+
+    // number of spans ever recorded
+    std::atomic<unsigned long> count;
+
+    TraceRing(int id) :
+        threadId(id),
+        count(0)
+    {}
+};
+
+class Tracer
+{
+private:
+    static Tracer* instance;
+
+    // read by every traced block, without creating the tracer when it is not
+    // enabled
+    static bool enabled;
+
+    std::chrono::steady_clock::time_point start;
+    std::string path;
+
+    // held only while a thread registers its ring, and while writing the trace
+    std::mutex ringsMutex;
+    std::vector<TraceRing*> rings;
+
+    TraceRing* getThreadRing();
+    static void writeTraceAtExit();
+
+protected:
+    Tracer();
+
+public:
+    static Tracer* getInstance();
+
+    // starts recording, the trace being written to file. Must be called
+    // before any other thread is started
+    void enable(std::string file);
+    static bool isEnabled();
+
+    // microseconds since the tracer was created
+    double now();
+
+    void addSpan(const char* name, double begin, double end);
+
+    // names the calling thread in the trace
+    void setThreadName(std::string name);
+
+    // writes the spans recorded so far. The recording threads should be idle,
+    // or the spans they overwrite meanwhile may be torn
+    void writeTrace();
+};
+
+// records the block it lives in as a span named name, which must be a string
+// literal
+class TraceScope
+{
+private:
+    const char* name;
+    double begin;
+
+public:
+    TraceScope(const char* n) :
+        name(n),
+        begin(Tracer::isEnabled() ? Tracer::getInstance()->now() : 0.0)
+    {}
+
+    ~TraceScope()
+    {
+        if(Tracer::isEnabled())
+        {
+            Tracer* tracer = Tracer::getInstance();
+            tracer->addSpan(name, begin, tracer->now());
+        }
+    }
+};
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_THREAD_NAME(name)
+
+#endif
+
+#endif
@@ -1,61 +1,4 @@
 #include "Triangle.h"
-#include "Arrow.h"
-#include "DrawingSettings.h"
-
-// OpenGL imports
-#include <GL/glut.h>
-#include <GL/gl.h>
-#include <GL/glu.h>
-
-void Triangle::draw()
-{
-    DrawingSettings* drawingSettings = DrawingSettings::getInstance();
-
-    if(drawingSettings->isDrawTrianglesEnabled())
-    {
-        glPushAttrib(GL_POLYGON_BIT); // save mesh settings
-            glPushAttrib(GL_CURRENT_BIT); // save color
-                glPushAttrib(GL_LIGHTING_BIT);
-
-                    glEnable(GL_LIGHTING);
-                    glEnable(GL_LIGHT0);
-                    glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
-
-                    Vector3 p1 = n1->getPosition();
-                    Vector3 p1_normal = n1->getNormal();
-
-                    Vector3 p2 = n2->getPosition();
-                    Vector3 p2_normal = n2->getNormal();
-
-                    Vector3 p3 = n3->getPosition();
-                    Vector3 p3_normal = n3->getNormal();
-
-                    Vector3 color = drawingSettings->getTriangleColor();
-
-                    GLfloat mat_amb_diff[] = {color.x, color.y, color.z, 1.0};
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, mat_amb_diff);
-
-                    glBegin(GL_TRIANGLES);
-                        glNormal3f(p1_normal.x, p1_normal.y, p1_normal.z);
-                        glVertex3f(p1.x, p1.y, p1.z);
-
-                        glNormal3f(p2_normal.x, p2_normal.y, p2_normal.z);
-                        glVertex3f(p2.x, p2.y, p2.z);
-
-                        glNormal3f(p3_normal.x, p3_normal.y, p3_normal.z);
-                        glVertex3f(p3.x, p3.y, p3.z);
-                    glEnd();
-
-                glPopAttrib(); // GL_LIGHTING_BIT
-            glPopAttrib(); // GL_CURRENT_BIT
-        glPopAttrib(); // GL_POLYGON_BIT
-
-        // draw normal vector
-        Vector3 center = (p1 + p2 + p3) / 3.0;
-        Arrow normalVector(center, center + normal);
-        normalVector.draw();
-    }
-}
 
 // declare points in counter-clockwise direction for all triangles to have the
 // same outer surface
@@ -69,4 +12,49 @@ Triangle::Triangle(Node* p1, Node* p2, Node* p3) :
 Vector3 Triangle::getNormal()
 {
     return normal;
-}
\ No newline at end of file
+}
+bool Triangle::projectPoint(Vector3 point, Vector3 p1, Vector3 p2, Vector3 p3, Vector3* normal, double* distance, Vector3* barycentric)
+{
+    Vector3 edge1 = p2 - p1;
+    Vector3 edge2 = p3 - p1;
+
+    Vector3 n = edge1.cross(edge2);
+    double doubleArea = n.length();
+
+    // degenerate triangle, which has no plane
+    if(doubleArea == 0.0)
+    {
+        return false;
+    }
+
+    n = n / doubleArea;
+
+    // 1) project point onto the plane of the triangle
+    double d = (point - p1).dot(n);
+    Vector3 toProjection = (point - n * d) - p1;
+
+    // 2) barycentric coordinates of the projection
+    double d11 = edge1.dot(edge1);
+    double d12 = edge1.dot(edge2);
+    double d22 = edge2.dot(edge2);
+    double dp1 = toProjection.dot(edge1);
+    double dp2 = toProjection.dot(edge2);
+    double denominator = d11 * d22 - d12 * d12;
+
+    double s2 = (d22 * dp1 - d12 * dp2) / denominator;
+    double s3 = (d11 * dp2 - d12 * dp1) / denominator;
+    double s1 = 1.0 - s2 - s3;
+
+    // 3) outside of the prism above and below the triangle
+    if(s1 < 0.0 || s2 < 0.0 || s3 < 0.0)
+    {
+        return false;
+    }
+
+    // 4) the sign of the distance tells on which side the point is
+    *normal = n;
+    *distance = d;
+    *barycentric = Vector3(s1, s2, s3);
+
+    return true;
+}
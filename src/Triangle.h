@@ -22,9 +22,16 @@ public:
     Vector3 normal;
 
     Triangle(Node* p1, Node* p2, Node* p3);
-    void draw();
 
     Vector3 getNormal();
+
+    // point-triangle intersection, following the algorithm above. Returns
+    // false if the projection of point onto the plane of the triangle
+    // (p1, p2, p3) is outside the triangle. Otherwise sets normal to the unit
+    // normal of the triangle, distance to the signed distance from the plane
+    // to point (positive on the side the normal points to), and barycentric
+    // to the barycentric coordinates (s1, s2, s3) of the projection
+    static bool projectPoint(Vector3 point, Vector3 p1, Vector3 p2, Vector3 p3, Vector3* normal, double* distance, Vector3* barycentric);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "TriangleBvh.h"
+
+#include <algorithm>
+
+// orders triangle ids by the coordinate of their centroid along one axis
+class CentroidComparator
+{
+private:
+    const std::vector<double>* centroid;
+
+public:
+    CentroidComparator(const std::vector<double>* axisCentroid) :
+        centroid(axisCentroid)
+    {}
+
+    bool operator()(int triangle1, int triangle2) const
+    {
+        return (*centroid)[triangle1] < (*centroid)[triangle2];
+    }
+};
+
+TriangleBvh::TriangleBvh() :
+    triangleIndices(0),
+    margin(0.0)
+{}
+
+void TriangleBvh::build(ParticleStore* particles, const std::vector<int>* indices, double boxMargin)
+{
+    triangleIndices = indices;
+    margin = boxMargin;
+
+    int numberTriangles = indices->size() / 3;
+
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    order.resize(numberTriangles);
+    centroidX.resize(numberTriangles);
+    centroidY.resize(numberTriangles);
+    centroidZ.resize(numberTriangles);
+
+    for(int t = 0; t < numberTriangles; t += 1)
+    {
+        int n1 = (*indices)[3 * t];
+        int n2 = (*indices)[3 * t + 1];
+        int n3 = (*indices)[3 * t + 2];
+
+        order[t] = t;
+        centroidX[t] = (positionX[n1] + positionX[n2] + positionX[n3]) / 3.0;
+        centroidY[t] = (positionY[n1] + positionY[n2] + positionY[n3]) / 3.0;
+        centroidZ[t] = (positionZ[n1] + positionZ[n2] + positionZ[n3]) / 3.0;
+    }
+
+    nodes.clear();
+
+    if(numberTriangles > 0)
+    {
+        buildNode(0, numberTriangles);
+    }
+
+    // a query never holds more nodes than the tree has
+    stack.reserve(nodes.size());
+
+    refit(particles);
+}
+
+// splits the triangles at the median of their centroids along the axis where
+// the centroids are spread the most. Returns the index of the created node
+int TriangleBvh::buildNode(int begin, int end)
+{
+    int index = nodes.size();
+    nodes.push_back(TriangleBvhNode());
+
+    if(end - begin <= TRIANGLE_BVH_LEAF_SIZE)
+    {
+        nodes[index].right = -1;
+        nodes[index].firstTriangle = begin;
+        nodes[index].numberTriangles = end - begin;
+
+        return index;
+    }
+
+    double minX = centroidX[order[begin]];
+    double minY = centroidY[order[begin]];
+    double minZ = centroidZ[order[begin]];
+    double maxX = minX;
+    double maxY = minY;
+    double maxZ = minZ;
+
+    for(int i = begin + 1; i < end; i += 1)
+    {
+        int t = order[i];
+        minX = std::min(minX, centroidX[t]);
+        minY = std::min(minY, centroidY[t]);
+        minZ = std::min(minZ, centroidZ[t]);
+        maxX = std::max(maxX, centroidX[t]);
+        maxY = std::max(maxY, centroidY[t]);
+        maxZ = std::max(maxZ, centroidZ[t]);
+    }
+
+    const std::vector<double>* axis = &centroidX;
+
+    if(maxY - minY > maxX - minX && maxY - minY >= maxZ - minZ)
+    {
+        axis = &centroidY;
+    }
+    else if(maxZ - minZ > maxX - minX && maxZ - minZ > maxY - minY)
+    {
+        axis = &centroidZ;
+    }
+
+    int middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, CentroidComparator(axis));
+
+    // the left child is always the node right after its parent
+    buildNode(begin, middle);
+    int right = buildNode(middle, end);
+
+    nodes[index].right = right;
+    nodes[index].firstTriangle = 0;
+    nodes[index].numberTriangles = 0;
+
+    return index;
+}
+
+void TriangleBvh::fitLeaf(ParticleStore* particles, TriangleBvhNode* node)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+
+    int first = (*triangleIndices)[3 * order[node->firstTriangle]];
+
+    double minX = positionX[first];
+    double minY = positionY[first];
+    double minZ = positionZ[first];
+    double maxX = minX;
+    double maxY = minY;
+    double maxZ = minZ;
+
+    for(int i = node->firstTriangle; i < node->firstTriangle + node->numberTriangles; i += 1)
+    {
+        for(int v = 0; v < 3; v += 1)
+        {
+            int n = (*triangleIndices)[3 * order[i] + v];
+
+            minX = std::min(minX, positionX[n]);
+            minY = std::min(minY, positionY[n]);
+            minZ = std::min(minZ, positionZ[n]);
+            maxX = std::max(maxX, positionX[n]);
+            maxY = std::max(maxY, positionY[n]);
+            maxZ = std::max(maxZ, positionZ[n]);
+        }
+    }
+
+    node->minX = minX - margin;
+    node->minY = minY - margin;
+    node->minZ = minZ - margin;
+    node->maxX = maxX + margin;
+    node->maxY = maxY + margin;
+    node->maxZ = maxZ + margin;
+}
+
+// children are always stored after their parent, so going through the nodes
+// backwards fits every child before its parent
+void TriangleBvh::refit(ParticleStore* particles)
+{
+    for(int i = nodes.size() - 1; i >= 0; i -= 1)
+    {
+        TriangleBvhNode* node = &nodes[i];
+
+        if(node->right == -1)
+        {
+            fitLeaf(particles, node);
+        }
+        else
+        {
+            TriangleBvhNode* left = &nodes[i + 1];
+            TriangleBvhNode* right = &nodes[node->right];
+
+            node->minX = std::min(left->minX, right->minX);
+            node->minY = std::min(left->minY, right->minY);
+            node->minZ = std::min(left->minZ, right->minZ);
+            node->maxX = std::max(left->maxX, right->maxX);
+            node->maxY = std::max(left->maxY, right->maxY);
+            node->maxZ = std::max(left->maxZ, right->maxZ);
+        }
+    }
+}
+
+void TriangleBvh::query(double minX, double minY, double minZ, double maxX, double maxY, double maxZ, std::vector<int>* triangles)
+{
+    if(nodes.empty())
+    {
+        return;
+    }
+
+    stack.clear();
+    stack.push_back(0);
+
+    while(!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+
+        TriangleBvhNode* node = &nodes[index];
+
+        if(node->minX > maxX || node->maxX < minX ||
+           node->minY > maxY || node->maxY < minY ||
+           node->minZ > maxZ || node->maxZ < minZ)
+        {
+            continue;
+        }
+
+        if(node->right == -1)
+        {
+            for(int i = node->firstTriangle; i < node->firstTriangle + node->numberTriangles; i += 1)
+            {
+                triangles->push_back(order[i]);
+            }
+        }
+        else
+        {
+            stack.push_back(node->right);
+            stack.push_back(index + 1);
+        }
+    }
+}
+
+double TriangleBvh::getMargin()
+{
+    return margin;
+}
+
+int TriangleBvh::getNumberNodes()
+{
+    return nodes.size();
+}
+
+long long TriangleBvh::getMemorySize()
+{
+    return nodes.capacity() * sizeof(TriangleBvhNode) +
+           (order.capacity() + stack.capacity()) * sizeof(int) +
+           (centroidX.capacity() + centroidY.capacity() + centroidZ.capacity()) * sizeof(double);
+}
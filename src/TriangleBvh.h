@@ -0,0 +1,77 @@
+#ifndef TRIANGLE_BVH_H
+#define TRIANGLE_BVH_H
+
+#include <vector>
+#include "ParticleStore.h"
+
+// maximum number of triangles in a leaf of the hierarchy
+#define TRIANGLE_BVH_LEAF_SIZE 4
+
+// axis aligned box of a part of the hierarchy. A node either has 2 children
+// (the left one right after it in the node array, the right one at index
+// right), or is a leaf holding numberTriangles triangles starting at
+// firstTriangle in the triangle order of the hierarchy
+class TriangleBvhNode
+{
+public:
+    double minX;
+    double minY;
+    double minZ;
+    double maxX;
+    double maxY;
+    double maxZ;
+
+    int right;
+    int firstTriangle;
+    int numberTriangles;
+};
+
+// Bounding volume hierarchy over the triangles of a cloth. The triangles are
+// given as 3 node indices each. As the cloth deforms, the boxes can be refit
+// to the new node positions without changing the tree, which is much cheaper
+// than building it again, but makes the boxes overlap more and more over
+// time, so the tree should still be rebuilt once in a while.
+class TriangleBvh
+{
+private:
+    std::vector<TriangleBvhNode> nodes;
+
+    // triangle ids, reordered so the triangles of each leaf are contiguous
+    std::vector<int> order;
+
+    // centroid of each triangle, only used while building
+    std::vector<double> centroidX;
+    std::vector<double> centroidY;
+    std::vector<double> centroidZ;
+
+    // nodes still to visit during a query
+    std::vector<int> stack;
+
+    const std::vector<int>* triangleIndices;
+    double margin;
+
+    int buildNode(int begin, int end);
+    void fitLeaf(ParticleStore* particles, TriangleBvhNode* node);
+
+public:
+    TriangleBvh();
+
+    // builds the tree over the triangles, and fits the boxes enlarged by
+    // boxMargin in every direction
+    void build(ParticleStore* particles, const std::vector<int>* indices, double boxMargin);
+
+    // fits the boxes of the current tree to the current node positions
+    void refit(ParticleStore* particles);
+
+    // appends to triangles the ids of the triangles whose box overlaps the
+    // given box
+    void query(double minX, double minY, double minZ, double maxX, double maxY, double maxZ, std::vector<int>* triangles);
+
+    double getMargin();
+    int getNumberNodes();
+
+    // bytes of the arrays
+    long long getMemorySize();
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Hands complete values from one writer thread to one reader thread without
+// locks. The writer fills the back slot and publishes it by swapping it with
+// the middle slot. The reader takes the middle slot in exchange for its front
+// slot when a newer value was published since the last time. Neither side
+// ever waits for the other, and the reader always sees the latest complete
+// value, skipping the ones published in between.
+#define TRIPLE_BUFFER_INDEX_MASK 3
+#define TRIPLE_BUFFER_FRESH 4
+
+template <typename T>
+class TripleBuffer
+{
+private:
+    T slots[3];
+
+    // index of the middle slot. TRIPLE_BUFFER_FRESH is set when it holds a
+    // value published after the one the reader has
+    std::atomic<int> middle;
+
+    // only used by the writer
+    int back;
+
+    // only used by the reader
+    int front;
+
+    TripleBuffer(const TripleBuffer& other);
+    TripleBuffer& operator=(const TripleBuffer& other);
+
+public:
+    TripleBuffer() :
+        middle(1),
+        back(0),
+        front(2)
+    {}
+
+    // gives access to all slots, to set them up before the buffer is shared
+    // between threads
+    T* getSlot(int i)
+    {
+        return &slots[i];
+    }
+
+    // slot the writer fills before publishing it
+    T* getWriteBuffer()
+    {
+        return &slots[back];
+    }
+
+    void publish()
+    {
+        back = middle.exchange(back | TRIPLE_BUFFER_FRESH, std::memory_order_acq_rel) & TRIPLE_BUFFER_INDEX_MASK;
+    }
+
+    // takes the latest published value if there is a new one. Returns false if
+    // the read buffer is unchanged
+    bool acquire()
+    {
+        if((middle.load(std::memory_order_relaxed) & TRIPLE_BUFFER_FRESH) == 0)
+        {
+            return false;
+        }
+
+        front = middle.exchange(front, std::memory_order_acq_rel) & TRIPLE_BUFFER_INDEX_MASK;
+        return true;
+    }
+
+    // slot the reader draws from, until the next acquire
+    T* getReadBuffer()
+    {
+        return &slots[front];
+    }
+};
+
+#endif
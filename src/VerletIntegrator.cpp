@@ -0,0 +1,192 @@
+#include "VerletIntegrator.h"
+#include "Simd.h"
+
+// smallest number of blocks of nodes handed to a thread at once
+#define INTEGRATION_GRAIN 128
+
+VerletIntegrator::VerletIntegrator(ParticleStore* store) :
+    particles(store),
+    duration(0.0),
+    kernel(SCALAR_KERNEL)
+{}
+
+void VerletIntegrator::integrate(float timeStep)
+{
+    WorkerPool* workerPool = WorkerPool::getInstance();
+
+    duration = timeStep;
+    kernel = SimulationSettings::getInstance()->getSimdKernel();
+
+    int numberBlocks = particles->getPaddedNumberParticles() / PARTICLE_STORE_PADDING;
+
+    int grain = numberBlocks / (4 * workerPool->getNumberThreads());
+    if(grain < INTEGRATION_GRAIN)
+    {
+        grain = INTEGRATION_GRAIN;
+    }
+
+    workerPool->run(this, numberBlocks, grain);
+}
+
+void VerletIntegrator::execute(int begin, int end)
+{
+    // the padding entries of the store are pinned, so whole blocks can be
+    // integrated without special care for the last nodes
+    int firstNode = begin * PARTICLE_STORE_PADDING;
+    int lastNode = end * PARTICLE_STORE_PADDING;
+
+    switch(kernel)
+    {
+        case AVX2_KERNEL:
+            integrateAvx2(particles, firstNode, lastNode, duration);
+            break;
+        case SSE2_KERNEL:
+            integrateSse2(particles, firstNode, lastNode, duration);
+            break;
+        default:
+            integrateScalar(particles, firstNode, lastNode, duration);
+            break;
+    }
+}
+
+void VerletIntegrator::integrateScalar(ParticleStore* particles, int begin, int end, double duration)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+    double* oldPositionX = particles->oldPositionX;
+    double* oldPositionY = particles->oldPositionY;
+    double* oldPositionZ = particles->oldPositionZ;
+    double* forceX = particles->forceX;
+    double* forceY = particles->forceY;
+    double* forceZ = particles->forceZ;
+    double* inverseMass = particles->inverseMass;
+    unsigned char* pinned = particles->pinned;
+
+    for(int i = begin; i < end; i += 1)
+    {
+        if(!pinned[i])
+        {
+            double accelerationFactor = inverseMass[i] * duration;
+
+            double x = positionX[i];
+            double y = positionY[i];
+            double z = positionZ[i];
+
+            positionX[i] = x + (x - oldPositionX[i]) + forceX[i] * accelerationFactor;
+            positionY[i] = y + (y - oldPositionY[i]) + forceY[i] * accelerationFactor;
+            positionZ[i] = z + (z - oldPositionZ[i]) + forceZ[i] * accelerationFactor;
+
+            oldPositionX[i] = x;
+            oldPositionY[i] = y;
+            oldPositionZ[i] = z;
+        }
+    }
+}
+
+#ifdef SIMD_X86_ENABLED
+
+// the vectorized kernels compute the same expressions as the scalar one, in
+// the same order, and select the old values for pinned nodes instead of
+// branching, so all kernels give identical results
+
+SIMD_TARGET_SSE2
+void VerletIntegrator::integrateSse2(ParticleStore* particles, int begin, int end, double duration)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+    double* oldPositionX = particles->oldPositionX;
+    double* oldPositionY = particles->oldPositionY;
+    double* oldPositionZ = particles->oldPositionZ;
+    double* forceX = particles->forceX;
+    double* forceY = particles->forceY;
+    double* forceZ = particles->forceZ;
+    double* inverseMass = particles->inverseMass;
+    double* mobility = particles->mobility;
+
+    const __m128d timeStep = _mm_set1_pd(duration);
+    const __m128d zero = _mm_setzero_pd();
+
+    for(int i = begin; i < end; i += 2)
+    {
+        __m128d moveable = _mm_cmpgt_pd(_mm_load_pd(&mobility[i]), zero);
+        __m128d accelerationFactor = _mm_mul_pd(_mm_load_pd(&inverseMass[i]), timeStep);
+
+        __m128d x = _mm_load_pd(&positionX[i]);
+        __m128d y = _mm_load_pd(&positionY[i]);
+        __m128d z = _mm_load_pd(&positionZ[i]);
+        __m128d oldX = _mm_load_pd(&oldPositionX[i]);
+        __m128d oldY = _mm_load_pd(&oldPositionY[i]);
+        __m128d oldZ = _mm_load_pd(&oldPositionZ[i]);
+
+        __m128d newX = _mm_add_pd(_mm_add_pd(x, _mm_sub_pd(x, oldX)), _mm_mul_pd(_mm_load_pd(&forceX[i]), accelerationFactor));
+        __m128d newY = _mm_add_pd(_mm_add_pd(y, _mm_sub_pd(y, oldY)), _mm_mul_pd(_mm_load_pd(&forceY[i]), accelerationFactor));
+        __m128d newZ = _mm_add_pd(_mm_add_pd(z, _mm_sub_pd(z, oldZ)), _mm_mul_pd(_mm_load_pd(&forceZ[i]), accelerationFactor));
+
+        // (moveable & new) | (~moveable & old)
+        _mm_store_pd(&positionX[i], _mm_or_pd(_mm_and_pd(moveable, newX), _mm_andnot_pd(moveable, x)));
+        _mm_store_pd(&positionY[i], _mm_or_pd(_mm_and_pd(moveable, newY), _mm_andnot_pd(moveable, y)));
+        _mm_store_pd(&positionZ[i], _mm_or_pd(_mm_and_pd(moveable, newZ), _mm_andnot_pd(moveable, z)));
+        _mm_store_pd(&oldPositionX[i], _mm_or_pd(_mm_and_pd(moveable, x), _mm_andnot_pd(moveable, oldX)));
+        _mm_store_pd(&oldPositionY[i], _mm_or_pd(_mm_and_pd(moveable, y), _mm_andnot_pd(moveable, oldY)));
+        _mm_store_pd(&oldPositionZ[i], _mm_or_pd(_mm_and_pd(moveable, z), _mm_andnot_pd(moveable, oldZ)));
+    }
+}
+
+SIMD_TARGET_AVX2
+void VerletIntegrator::integrateAvx2(ParticleStore* particles, int begin, int end, double duration)
+{
+    double* positionX = particles->positionX;
+    double* positionY = particles->positionY;
+    double* positionZ = particles->positionZ;
+    double* oldPositionX = particles->oldPositionX;
+    double* oldPositionY = particles->oldPositionY;
+    double* oldPositionZ = particles->oldPositionZ;
+    double* forceX = particles->forceX;
+    double* forceY = particles->forceY;
+    double* forceZ = particles->forceZ;
+    double* inverseMass = particles->inverseMass;
+    double* mobility = particles->mobility;
+
+    const __m256d timeStep = _mm256_set1_pd(duration);
+    const __m256d zero = _mm256_setzero_pd();
+
+    for(int i = begin; i < end; i += 4)
+    {
+        __m256d moveable = _mm256_cmp_pd(_mm256_load_pd(&mobility[i]), zero, _CMP_GT_OQ);
+        __m256d accelerationFactor = _mm256_mul_pd(_mm256_load_pd(&inverseMass[i]), timeStep);
+
+        __m256d x = _mm256_load_pd(&positionX[i]);
+        __m256d y = _mm256_load_pd(&positionY[i]);
+        __m256d z = _mm256_load_pd(&positionZ[i]);
+        __m256d oldX = _mm256_load_pd(&oldPositionX[i]);
+        __m256d oldY = _mm256_load_pd(&oldPositionY[i]);
+        __m256d oldZ = _mm256_load_pd(&oldPositionZ[i]);
+
+        __m256d newX = _mm256_add_pd(_mm256_add_pd(x, _mm256_sub_pd(x, oldX)), _mm256_mul_pd(_mm256_load_pd(&forceX[i]), accelerationFactor));
+        __m256d newY = _mm256_add_pd(_mm256_add_pd(y, _mm256_sub_pd(y, oldY)), _mm256_mul_pd(_mm256_load_pd(&forceY[i]), accelerationFactor));
+        __m256d newZ = _mm256_add_pd(_mm256_add_pd(z, _mm256_sub_pd(z, oldZ)), _mm256_mul_pd(_mm256_load_pd(&forceZ[i]), accelerationFactor));
+
+        _mm256_store_pd(&positionX[i], _mm256_blendv_pd(x, newX, moveable));
+        _mm256_store_pd(&positionY[i], _mm256_blendv_pd(y, newY, moveable));
+        _mm256_store_pd(&positionZ[i], _mm256_blendv_pd(z, newZ, moveable));
+        _mm256_store_pd(&oldPositionX[i], _mm256_blendv_pd(oldX, x, moveable));
+        _mm256_store_pd(&oldPositionY[i], _mm256_blendv_pd(oldY, y, moveable));
+        _mm256_store_pd(&oldPositionZ[i], _mm256_blendv_pd(oldZ, z, moveable));
+    }
+}
+
+#else
+
+void VerletIntegrator::integrateSse2(ParticleStore* particles, int begin, int end, double duration)
+{
+    integrateScalar(particles, begin, end, duration);
+}
+
+void VerletIntegrator::integrateAvx2(ParticleStore* particles, int begin, int end, double duration)
+{
+    integrateScalar(particles, begin, end, duration);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef VERLET_INTEGRATOR_H
+#define VERLET_INTEGRATOR_H
+
+#include "ParticleStore.h"
+#include "WorkerPool.h"
+#include "SimulationSettings.h"
+
+// Moves every node of a particle store according to the force applied to it
+// (verlet integration). The update is done in a single sweep over the
+// position, previous position and force arrays, with the vectorized kernel
+// selected in SimulationSettings, and the nodes are split across the worker
+// pool.
+class VerletIntegrator : public ParallelTask
+{
+private:
+    ParticleStore* particles;
+
+    // parameters of the integration being run by execute()
+    double duration;
+    SimdKernel kernel;
+
+    static void integrateScalar(ParticleStore* particles, int begin, int end, double duration);
+    static void integrateSse2(ParticleStore* particles, int begin, int end, double duration);
+    static void integrateAvx2(ParticleStore* particles, int begin, int end, double duration);
+
+public:
+    VerletIntegrator(ParticleStore* store);
+
+    void integrate(float timeStep);
+
+    // integrates blocks [begin, end) of PARTICLE_STORE_PADDING nodes
+    void execute(int begin, int end);
+};
+
+#endif
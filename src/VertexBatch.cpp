@@ -0,0 +1,52 @@
+#include "VertexBatch.h"
+
+#ifndef HEADLESS
+// OpenGL imports
+#include <GL/glut.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
+
+VertexBatch::VertexBatch()
+{}
+
+void VertexBatch::clear()
+{
+    vertices.clear();
+}
+
+void VertexBatch::addVertex(double x, double y, double z)
+{
+    vertices.push_back(x);
+    vertices.push_back(y);
+    vertices.push_back(z);
+}
+
+void VertexBatch::addVertex(Vector3 v)
+{
+    addVertex(v.x, v.y, v.z);
+}
+
+void VertexBatch::addLine(Vector3 begin, Vector3 end)
+{
+    addVertex(begin);
+    addVertex(end);
+}
+
+int VertexBatch::getNumberVertices()
+{
+    return vertices.size() / 3;
+}
+
+void VertexBatch::draw()
+{
+#ifndef HEADLESS
+    if(vertices.empty())
+    {
+        return;
+    }
+
+    glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+    glDrawArrays(GL_LINES, 0, getNumberVertices());
+#endif
+}
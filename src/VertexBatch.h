@@ -0,0 +1,34 @@
+#ifndef VERTEX_BATCH_H
+#define VERTEX_BATCH_H
+
+#include <vector>
+#include "Vector3.h"
+
+// Vertices of one kind of debug lines (constraint lines, arrows, ...),
+// gathered over a frame and drawn with a single call instead of one
+// glBegin / glEnd per line. The state it is drawn with is set by the
+// RenderPass it is submitted to.
+class VertexBatch
+{
+private:
+    // 3 floats per vertex
+    std::vector<float> vertices;
+
+public:
+    VertexBatch();
+
+    // empties the batch, keeping its memory for the next frame
+    void clear();
+
+    void addVertex(double x, double y, double z);
+    void addVertex(Vector3 v);
+    void addLine(Vector3 begin, Vector3 end);
+
+    int getNumberVertices();
+
+    // draws the vertices as lines, 2 per line, in the current color. The
+    // vertex array must be enabled
+    void draw();
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "WorkerPool.h"
+#include "SimulationSettings.h"
+#include "Tracer.h"
+
+// number of times a thread polls for new work (or for the end of the current
+// job) before going to sleep. Keeps the latency of back to back jobs, like
+// the constraint batches, low.
+#define WORKER_POOL_SPIN_COUNT 4096
+
+WorkerPool* WorkerPool::instance = 0;
+
+WorkerPool* WorkerPool::getInstance()
+{
+    if(instance == 0)
+    {
+        instance = new WorkerPool();
+    }
+
+    return instance;
+}
+
+WorkerPool::WorkerPool() :
+    task(0),
+    numberItems(0),
+    grainSize(1),
+    nextItem(0),
+    activeWorkers(0),
+    generation(0),
+    stopping(false)
+{}
+
+int WorkerPool::getNumberThreads()
+{
+    return workers.size() + 1;
+}
+
+void WorkerPool::startWorkers(int numberWorkers)
+{
+    stopping = false;
+
+    for(int i = 0; i < numberWorkers; i += 1)
+    {
+        workers.push_back(std::thread(&WorkerPool::workerLoop, this, generation.load()));
+    }
+}
+
+void WorkerPool::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for(std::vector<std::thread>::iterator it = workers.begin();
+        it != workers.end();
+        ++it)
+    {
+        it->join();
+    }
+
+    workers.clear();
+}
+
+void WorkerPool::run(ParallelTask* parallelTask, int items, int grain)
+{
+    int numberThreads = SimulationSettings::getInstance()->getNumberThreads();
+
+    if(numberThreads != getNumberThreads())
+    {
+        stopWorkers();
+        startWorkers(numberThreads - 1);
+    }
+
+    // not worth waking up the workers
+    if(workers.empty() || items <= grain)
+    {
+        parallelTask->execute(0, items);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = parallelTask;
+        numberItems = items;
+        grainSize = grain;
+        nextItem.store(0);
+        activeWorkers.store(workers.size());
+        generation.fetch_add(1);
+    }
+    workAvailable.notify_all();
+
+    // the calling thread works too
+    processItems();
+
+    for(int spin = 0; spin < WORKER_POOL_SPIN_COUNT && activeWorkers.load() != 0; spin += 1)
+    {
+        std::this_thread::yield();
+    }
+
+    if(activeWorkers.load() != 0)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(activeWorkers.load() != 0)
+        {
+            workDone.wait(lock);
+        }
+    }
+}
+
+void WorkerPool::processItems()
+{
+    TRACE_SCOPE("parallel task");
+
+    while(true)
+    {
+        int begin = nextItem.fetch_add(grainSize);
+
+        if(begin >= numberItems)
+        {
+            break;
+        }
+
+        int end = begin + grainSize < numberItems ? begin + grainSize : numberItems;
+        task->execute(begin, end);
+    }
+}
+
+void WorkerPool::workerLoop(unsigned long startGeneration)
+{
+    unsigned long seenGeneration = startGeneration;
+
+    TRACE_THREAD_NAME("worker");
+
+    while(true)
+    {
+        for(int spin = 0; spin < WORKER_POOL_SPIN_COUNT && generation.load() == seenGeneration; spin += 1)
+        {
+            std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while(!stopping && generation.load() == seenGeneration)
+            {
+                workAvailable.wait(lock);
+            }
+
+            if(stopping)
+            {
+                return;
+            }
+
+            seenGeneration = generation.load();
+        }
+
+        processItems();
+
+        if(activeWorkers.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            workDone.notify_one();
+        }
+    }
+}
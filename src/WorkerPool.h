@@ -0,0 +1,62 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// A piece of work which can be split over a range of items. Implementations
+// must be safe to call concurrently on disjoint ranges.
+class ParallelTask
+{
+public:
+    virtual ~ParallelTask() {}
+
+    // processes the items in [begin, end)
+    virtual void execute(int begin, int end) = 0;
+};
+
+// Pool of persistent worker threads. The number of threads follows
+// SimulationSettings::getNumberThreads(), the calling thread counting as one
+// of them.
+class WorkerPool
+{
+private:
+    static WorkerPool* instance;
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+
+    // current job, published by incrementing generation
+    ParallelTask* task;
+    int numberItems;
+    int grainSize;
+    std::atomic<int> nextItem;
+    std::atomic<int> activeWorkers;
+    std::atomic<unsigned long> generation;
+    bool stopping;
+
+    void startWorkers(int numberWorkers);
+    void stopWorkers();
+    void workerLoop(unsigned long startGeneration);
+    void processItems();
+
+protected:
+    WorkerPool();
+
+public:
+    static WorkerPool* getInstance();
+
+    int getNumberThreads();
+
+    // runs task over [0, numberItems) in chunks of grain items, and returns
+    // once every item has been processed
+    void run(ParallelTask* parallelTask, int items, int grain);
+};
+
+#endif
@@ -0,0 +1,444 @@
+// compile with the following command:
+//     clear; g++ -O2 -pthread -DHEADLESS -o benchmark benchmark.cpp Node.cpp ParticleStore.cpp Camera.cpp Constraint.cpp VerletIntegrator.cpp ColoredConstraintSolver.cpp WorkerPool.cpp SimulationSettings.cpp Sphere.cpp SphereCollider.cpp SphereGrid.cpp SpatialHashGrid.cpp NeighborList.cpp Triangle.cpp TriangleBvh.cpp Cloth.cpp ClothFrame.cpp ClothMesh.cpp VertexBatch.cpp SphereMesh.cpp SphereBatch.cpp RenderPass.cpp Profiler.cpp PerfCounters.cpp AllocationCounter.cpp Tracer.cpp Scene.cpp BatmanScene.cpp DrawingSettings.cpp; ./benchmark
+//
+// Times the building blocks of a simulation step one at a time, on the cape
+// of the ball scene at several sizes and interleaving levels, and prints the
+// time per node (or per constraint) and the memory bandwidth it achieved.
+// Nothing in here may use OpenGL or GLUT.
+//
+// The bandwidth is the number of bytes each kernel reads and writes in the
+// arrays it streams over, divided by its time. It does not tell whether the
+// bytes came from the caches or from memory, so it is mostly meaningful once
+// the cape no longer fits in the caches.
+//
+// The cape is put back to its initial state before each run of a kernel,
+// outside of the timed part, so every run does the same work. The profiler
+// and the tracer are left out of the build, so they do not add their own
+// cost to the kernels.
+
+#include "BatmanScene.h"
+#include "DrawingSettings.h"
+#include "SimulationSettings.h"
+#include "Matrix4.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+
+// kernels are run until they were timed for this many seconds
+#define BENCHMARK_MINIMUM_TIME 0.05
+#define BENCHMARK_MINIMUM_RUNS 3
+
+// the brute force self collision is quadratic, so it is skipped on capes with
+// more nodes than this
+#define BENCHMARK_BRUTE_FORCE_MAXIMUM_NODES 1600
+
+// spacing, in nodes, of the spheres of the large set of spheres
+#define BENCHMARK_SPHERE_SPACING 4
+
+enum BenchmarkKernel
+{
+    BENCHMARK_INTEGRATION,
+    BENCHMARK_CONSTRAINTS,
+    BENCHMARK_SPHERE_COLLISION,
+    BENCHMARK_SELF_COLLISION,
+    BENCHMARK_NORMALS,
+    BENCHMARK_VECTOR_ADD,
+    BENCHMARK_VECTOR_CROSS,
+    BENCHMARK_MATRIX_TRANSFORM
+};
+
+// state of the cape a kernel runs on, saved once and put back before each run
+class CapeState
+{
+public:
+    std::vector<double> arrays[9];
+
+    void save(ParticleStore* particles);
+    void restore(ParticleStore* particles);
+};
+
+// arrays of vectors as large as the cape, for the Vector3 and Matrix4 kernels
+class VectorArrays
+{
+public:
+    std::vector<Vector3> a;
+    std::vector<Vector3> b;
+    std::vector<Vector3> result;
+    Matrix4 transform;
+
+    VectorArrays(int count);
+};
+
+void showUsage();
+bool parseArguments(int argc, char** argv);
+void benchmarkCape(int width, int levels);
+double timeKernel(BenchmarkKernel kernel, BatmanScene* scene, std::vector<Sphere>* spheres, VectorArrays* vectors);
+void runKernel(BenchmarkKernel kernel, BatmanScene* scene, std::vector<Sphere>* spheres, VectorArrays* vectors);
+void showResult(std::string name, double seconds, int numberItems, std::string item, double bytesPerItem);
+void createSpheres(Cloth* cape, std::vector<Sphere>* ball, std::vector<Sphere>* grid);
+
+// sizes and interleaving levels benchmarked, unless one is given
+int defaultNodesWidths[] = {10, 20, 40, 80};
+int defaultInterleavings[] = {1, 2, 3};
+std::vector<int> nodesWidths(defaultNodesWidths, defaultNodesWidths + 4);
+std::vector<int> interleavings(defaultInterleavings, defaultInterleavings + 3);
+
+CapeState initialState;
+
+int main(int argc, char** argv)
+{
+    if(!parseArguments(argc, argv))
+    {
+        showUsage();
+        return 1;
+    }
+
+    SimulationSettings::getInstance()->showSimulationStatus();
+
+    for(unsigned int s = 0; s < nodesWidths.size(); s += 1)
+    {
+        for(unsigned int l = 0; l < interleavings.size(); l += 1)
+        {
+            benchmarkCape(nodesWidths[s], interleavings[l]);
+        }
+    }
+
+    return 0;
+}
+
+void benchmarkCape(int width, int levels)
+{
+    SimulationSettings* settings = SimulationSettings::getInstance();
+    SimdKernel originalKernel = settings->getSimdKernel();
+    ConstraintSolverMode originalSolver = settings->getConstraintSolverMode();
+    SelfCollisionMode originalSelfCollision = settings->getSelfCollisionMode();
+
+    BatmanScene scene(false, width, levels);
+    Cloth* cape = scene.getCape();
+    ParticleStore* particles = cape->getParticles();
+
+    int numberNodes = particles->getNumberParticles();
+    int numberConstraints = cape->getNumberConstraints();
+
+    std::vector<Sphere> ball;
+    std::vector<Sphere> sphereSet;
+    createSpheres(cape, &ball, &sphereSet);
+
+    VectorArrays vectors(numberNodes);
+
+    initialState.save(particles);
+
+    std::cout << "cape of " << cape->getNumberNodesWidth() << " x " << cape->getNumberNodesHeight() << " nodes, "
+              << numberConstraints << " constraints, interleaving " << levels << ":" << std::endl;
+
+    // positions, previous positions and forces read, inverse masses and
+    // pinned flags read, positions and previous positions written
+    double integrationBytes = 3 * 3 * sizeof(double) + sizeof(double) + 1 + 2 * 3 * sizeof(double);
+
+    // the constraint, and the positions and pinned flag of both of its nodes,
+    // the positions being written back
+    double constraintBytes = sizeof(Constraint) + 2 * (2 * 3 * sizeof(double) + 1);
+
+    // positions read once per sphere tested against every node, or once per
+    // node with the sphere grid
+    double positionBytes = 3 * sizeof(double);
+
+    // positions, previous positions and forces read, positions, forces,
+    // normals and mesh vertices of the frame written
+    double frameBytes = 3 * 3 * sizeof(double) + 3 * 3 * sizeof(double) + CLOTH_FRAME_VERTEX_SIZE * sizeof(float);
+
+    for(int k = SCALAR_KERNEL; k <= AVX2_KERNEL; k += 1)
+    {
+        if(!settings->isSimdKernelSupported((SimdKernel) k))
+        {
+            continue;
+        }
+
+        settings->setSimdKernel((SimdKernel) k);
+        showResult("integration " + settings->getSimdKernelName((SimdKernel) k),
+                   timeKernel(BENCHMARK_INTEGRATION, &scene, 0, 0), numberNodes, "node", integrationBytes);
+    }
+
+    settings->setSimdKernel(originalKernel);
+    settings->setConstraintSolverMode(SEQUENTIAL_SOLVER);
+    showResult("constraints sequential",
+               timeKernel(BENCHMARK_CONSTRAINTS, &scene, 0, 0), numberConstraints, "constraint", constraintBytes);
+
+    settings->setConstraintSolverMode(COLORED_SOLVER);
+    for(int k = SCALAR_KERNEL; k <= AVX2_KERNEL; k += 1)
+    {
+        if(!settings->isSimdKernelSupported((SimdKernel) k))
+        {
+            continue;
+        }
+
+        settings->setSimdKernel((SimdKernel) k);
+        showResult("constraints colored " + settings->getSimdKernelName((SimdKernel) k),
+                   timeKernel(BENCHMARK_CONSTRAINTS, &scene, 0, 0), numberConstraints, "constraint", constraintBytes);
+    }
+
+    settings->setConstraintSolverMode(originalSolver);
+
+    for(int k = SCALAR_KERNEL; k <= AVX2_KERNEL; k += 1)
+    {
+        if(!settings->isSimdKernelSupported((SimdKernel) k))
+        {
+            continue;
+        }
+
+        settings->setSimdKernel((SimdKernel) k);
+        showResult("1 sphere " + settings->getSimdKernelName((SimdKernel) k),
+                   timeKernel(BENCHMARK_SPHERE_COLLISION, &scene, &ball, 0), numberNodes, "node", positionBytes);
+    }
+
+    settings->setSimdKernel(originalKernel);
+
+    // smaller sets are tested against every node, like the single sphere
+    std::string setName = std::to_string(sphereSet.size()) + " spheres";
+    if(sphereSet.size() >= SPHERE_GRID_MINIMUM_SPHERES)
+    {
+        setName += " grid";
+        showResult(setName, timeKernel(BENCHMARK_SPHERE_COLLISION, &scene, &sphereSet, 0), numberNodes, "node", positionBytes);
+    }
+    else
+    {
+        showResult(setName, timeKernel(BENCHMARK_SPHERE_COLLISION, &scene, &sphereSet, 0), numberNodes, "node", positionBytes * sphereSet.size());
+    }
+
+    // self collisions follow no regular access pattern, so only their time is
+    // shown
+    for(int m = BRUTE_FORCE_SELF_COLLISION; m <= NEIGHBOR_LIST_SELF_COLLISION; m += 1)
+    {
+        if(m == BRUTE_FORCE_SELF_COLLISION && numberNodes > BENCHMARK_BRUTE_FORCE_MAXIMUM_NODES)
+        {
+            continue;
+        }
+
+        settings->setSelfCollisionMode((SelfCollisionMode) m);
+        showResult("self collision " + settings->getSelfCollisionModeName((SelfCollisionMode) m),
+                   timeKernel(BENCHMARK_SELF_COLLISION, &scene, 0, 0), numberNodes, "node", 0.0);
+    }
+
+    settings->setSelfCollisionMode(originalSelfCollision);
+
+    showResult("normals and mesh", timeKernel(BENCHMARK_NORMALS, &scene, 0, 0), numberNodes, "node", frameBytes);
+
+    showResult("Vector3 a + b * s", timeKernel(BENCHMARK_VECTOR_ADD, &scene, 0, &vectors), numberNodes, "vector", 3 * sizeof(Vector3));
+    showResult("Vector3 cross normalize", timeKernel(BENCHMARK_VECTOR_CROSS, &scene, 0, &vectors), numberNodes, "vector", 3 * sizeof(Vector3));
+    showResult("Matrix4 * Vector3", timeKernel(BENCHMARK_MATRIX_TRANSFORM, &scene, 0, &vectors), numberNodes, "vector", 2 * sizeof(Vector3));
+
+    std::cout << std::endl;
+}
+
+// average seconds per run of kernel. The first run is not timed, so the
+// kernels which create their buffers when first used are timed without it
+double timeKernel(BenchmarkKernel kernel, BatmanScene* scene, std::vector<Sphere>* spheres, VectorArrays* vectors)
+{
+    ParticleStore* particles = scene->getCape()->getParticles();
+
+    initialState.restore(particles);
+    runKernel(kernel, scene, spheres, vectors);
+
+    double total = 0.0;
+    int numberRuns = 0;
+
+    while(total < BENCHMARK_MINIMUM_TIME || numberRuns < BENCHMARK_MINIMUM_RUNS)
+    {
+        initialState.restore(particles);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        runKernel(kernel, scene, spheres, vectors);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        total += std::chrono::duration<double>(end - start).count();
+        numberRuns += 1;
+    }
+
+    initialState.restore(particles);
+
+    return total / numberRuns;
+}
+
+void runKernel(BenchmarkKernel kernel, BatmanScene* scene, std::vector<Sphere>* spheres, VectorArrays* vectors)
+{
+    Cloth* cape = scene->getCape();
+
+    switch(kernel)
+    {
+        case BENCHMARK_INTEGRATION:
+            cape->applyForces(DrawingSettings::getInstance()->getOriginalTimeStep());
+            break;
+        case BENCHMARK_CONSTRAINTS:
+            cape->satisfyConstraints();
+            break;
+        case BENCHMARK_SPHERE_COLLISION:
+            cape->handleSphereIntersections(spheres);
+            break;
+        case BENCHMARK_SELF_COLLISION:
+            cape->handleSelfIntersections();
+            break;
+        case BENCHMARK_NORMALS:
+            cape->updateRenderState(0.5);
+            break;
+
+        case BENCHMARK_VECTOR_ADD:
+            for(unsigned int i = 0; i < vectors->result.size(); i += 1)
+            {
+                vectors->result[i] = vectors->a[i] + vectors->b[i] * 0.5;
+            }
+            break;
+        case BENCHMARK_VECTOR_CROSS:
+            for(unsigned int i = 0; i < vectors->result.size(); i += 1)
+            {
+                vectors->result[i] = vectors->a[i].cross(vectors->b[i]).normalize();
+            }
+            break;
+        case BENCHMARK_MATRIX_TRANSFORM:
+            for(unsigned int i = 0; i < vectors->result.size(); i += 1)
+            {
+                vectors->result[i] = vectors->transform * vectors->a[i];
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void showResult(std::string name, double seconds, int numberItems, std::string item, double bytesPerItem)
+{
+    std::cout << "  " << name << std::string(32 - name.size(), ' ') << ": "
+              << 1e9 * seconds / numberItems << " ns per " << item;
+
+    if(bytesPerItem > 0.0)
+    {
+        std::cout << ", " << bytesPerItem * numberItems / seconds / 1e9 << " GB/s";
+    }
+
+    std::cout << std::endl;
+}
+
+// a sphere on the middle node of the cape, and a set of smaller spheres on
+// every few nodes, so both sets are in contact with the cape
+void createSpheres(Cloth* cape, std::vector<Sphere>* ball, std::vector<Sphere>* sphereSet)
+{
+    int width = cape->getNumberNodesWidth();
+    int height = cape->getNumberNodesHeight();
+    float spacing = cape->getClothWidth() / width;
+
+    Vector3 middle = cape->getNode(width / 2, height / 2)->getPosition();
+    ball->push_back(Sphere(middle, cape->getClothWidth() / 4.0));
+
+    for(int x = 0; x < width; x += BENCHMARK_SPHERE_SPACING)
+    {
+        for(int y = 0; y < height; y += BENCHMARK_SPHERE_SPACING)
+        {
+            sphereSet->push_back(Sphere(cape->getNode(x, y)->getPosition(), 1.5 * spacing));
+        }
+    }
+}
+
+void CapeState::save(ParticleStore* particles)
+{
+    double* sources[9] = {particles->positionX,    particles->positionY,    particles->positionZ,
+                          particles->oldPositionX, particles->oldPositionY, particles->oldPositionZ,
+                          particles->forceX,       particles->forceY,       particles->forceZ};
+
+    for(int a = 0; a < 9; a += 1)
+    {
+        arrays[a].assign(sources[a], sources[a] + particles->getPaddedNumberParticles());
+    }
+}
+
+void CapeState::restore(ParticleStore* particles)
+{
+    double* destinations[9] = {particles->positionX,    particles->positionY,    particles->positionZ,
+                               particles->oldPositionX, particles->oldPositionY, particles->oldPositionZ,
+                               particles->forceX,       particles->forceY,       particles->forceZ};
+
+    for(int a = 0; a < 9; a += 1)
+    {
+        memcpy(destinations[a], &arrays[a][0], arrays[a].size() * sizeof(double));
+    }
+}
+
+VectorArrays::VectorArrays(int count) :
+    a(count),
+    b(count),
+    result(count),
+    transform(0.0, -1.0, 0.0, 1.0,
+              1.0,  0.0, 0.0, 2.0,
+              0.0,  0.0, 1.0, 3.0,
+              0.0,  0.0, 0.0, 1.0)
+{
+    for(int i = 0; i < count; i += 1)
+    {
+        a[i] = Vector3(i, 1.0, 2.0);
+        b[i] = Vector3(1.0, i, 0.5);
+    }
+}
+
+void showUsage()
+{
+    std::cout << "usage: benchmark [options]" << std::endl;
+    std::cout << "  --help, -h                            show this help" << std::endl;
+    std::cout << "  --nodes N                             only benchmark capes N nodes wide (default 10, 20, 40 and 80)" << std::endl;
+    std::cout << "  --interleaving L                      only benchmark interleaving level L (default 1, 2 and 3)" << std::endl;
+    std::cout << "  --threads N                           number of simulation threads" << std::endl;
+}
+
+// returns false if the arguments are not valid
+bool parseArguments(int argc, char** argv)
+{
+    for(int i = 1; i < argc; i += 1)
+    {
+        std::string option = argv[i];
+
+        if(option == "--help" || option == "-h")
+        {
+            showUsage();
+            exit(0);
+        }
+
+        if(option != "--nodes" && option != "--interleaving" && option != "--threads")
+        {
+            std::cerr << "unknown option " << option << std::endl;
+            return false;
+        }
+
+        // every option takes a value
+        if(i + 1 >= argc)
+        {
+            std::cerr << "missing value for " << option << std::endl;
+            return false;
+        }
+
+        std::string value = argv[i + 1];
+        i += 1;
+
+        if(option == "--nodes")
+        {
+            nodesWidths.assign(1, atoi(value.c_str()));
+        }
+        else if(option == "--interleaving")
+        {
+            interleavings.assign(1, atoi(value.c_str()));
+        }
+        else if(option == "--threads")
+        {
+            SimulationSettings::getInstance()->setNumberThreads(atoi(value.c_str()));
+        }
+    }
+
+    if(nodesWidths[0] < 2 || interleavings[0] < 1)
+    {
+        std::cerr << "invalid cape size or interleaving level" << std::endl;
+        return false;
+    }
+
+    return true;
+}
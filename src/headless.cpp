@@ -0,0 +1,421 @@
+// compile with the following command:
+//     clear; g++ -O2 -pthread -DHEADLESS -DENABLE_PROFILER -DENABLE_TRACER -DENABLE_ALLOCATION_COUNTER -o headless headless.cpp Node.cpp ParticleStore.cpp Camera.cpp Constraint.cpp VerletIntegrator.cpp ColoredConstraintSolver.cpp WorkerPool.cpp SimulationSettings.cpp Sphere.cpp SphereCollider.cpp SphereGrid.cpp SpatialHashGrid.cpp NeighborList.cpp Triangle.cpp TriangleBvh.cpp Cloth.cpp ClothFrame.cpp ClothMesh.cpp VertexBatch.cpp SphereMesh.cpp SphereBatch.cpp RenderPass.cpp Profiler.cpp PerfCounters.cpp AllocationCounter.cpp Tracer.cpp Scene.cpp BatmanScene.cpp DrawingSettings.cpp; ./headless --steps 1000
+//
+// Runs a scene without any window, as fast as possible, and prints how long
+// it took. Nothing in here may use OpenGL or GLUT.
+//
+// The cloth and the scenes still own their meshes and batches, so ClothMesh,
+// VertexBatch, SphereMesh, SphereBatch and RenderPass are linked as well. With
+// HEADLESS they compile without any OpenGL call, and nothing here draws.
+
+#include "BatmanScene.h"
+#include "DrawingSettings.h"
+#include "SimulationSettings.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <stdlib.h>
+
+void showUsage();
+bool parseArguments(int argc, char** argv);
+bool isValueOption(std::string option);
+
+bool runningScene = false;
+int nodesWidth = 20;
+int interleaving = -1;
+float timeStep = -1.0;
+int numberSteps = 1000;
+bool checkAllocations = false;
+bool checkTriangleContacts = false;
+
+// steps simulated before the allocations are checked, so the buffers which
+// grow with the contacts can reach their size
+#define ALLOCATION_CHECK_WARMUP_STEPS 100
+
+int main(int argc, char** argv)
+{
+    if(!parseArguments(argc, argv))
+    {
+        showUsage();
+        return 1;
+    }
+
+    TRACE_THREAD_NAME("main");
+
+    // same default rigidity as the interactive scenes
+    if(interleaving < 0)
+    {
+        interleaving = runningScene ? 2 : 1;
+    }
+
+    BatmanScene scene(runningScene, nodesWidth, interleaving);
+    Cloth* cape = scene.getCape();
+
+    DrawingSettings* drawingSettings = DrawingSettings::getInstance();
+    if(timeStep < 0.0)
+    {
+        timeStep = drawingSettings->getOriginalTimeStep();
+    }
+    drawingSettings->setTimeStep(timeStep);
+
+    SimulationSettings::getInstance()->showSimulationStatus();
+
+    std::cout << "scene                           : " << (runningScene ? "running" : "ball") << std::endl;
+    std::cout << "nodes                           : " << cape->getNumberNodesWidth() << " x " << cape->getNumberNodesHeight() << std::endl;
+    std::cout << "constraints                     : " << cape->getNumberConstraints() << std::endl;
+    std::cout << "time step                       : " << timeStep << std::endl;
+    std::cout << "steps                           : " << numberSteps << std::endl;
+    std::cout << std::endl;
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+    // allocations of each phase at the end of the warm-up, and after it
+    long long warmupAllocations[ALLOCATION_OUTSIDE_PHASES + 1];
+    long long phaseAllocations[ALLOCATION_OUTSIDE_PHASES + 1];
+    long long stepAllocations = 0;
+#endif
+
+    // a node rarely touches more than one triangle, so a step with more
+    // contacts than nodes means the cloth is being crushed
+    int mostTriangleContacts = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for(int step = 0; step < numberSteps; step += 1)
+    {
+#ifdef ENABLE_ALLOCATION_COUNTER
+        if(step == ALLOCATION_CHECK_WARMUP_STEPS)
+        {
+            for(int phase = 0; phase <= ALLOCATION_OUTSIDE_PHASES; phase += 1)
+            {
+                warmupAllocations[phase] = AllocationCounter::getNumberAllocations(phase);
+            }
+        }
+
+        long long allocationsBefore = AllocationCounter::getNumberAllocations();
+#endif
+
+        {
+            PROFILE_SCOPE(PROFILE_SIMULATION);
+            scene.simulate();
+        }
+
+        mostTriangleContacts = std::max(mostTriangleContacts, cape->getNumberTriangleContacts());
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+        if(step >= ALLOCATION_CHECK_WARMUP_STEPS)
+        {
+            stepAllocations += AllocationCounter::getNumberAllocations() - allocationsBefore;
+        }
+#endif
+
+#ifdef ENABLE_PROFILER
+        Profiler::getInstance()->endFrame();
+#endif
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+    for(int phase = 0; phase <= ALLOCATION_OUTSIDE_PHASES && checkAllocations; phase += 1)
+    {
+        phaseAllocations[phase] = AllocationCounter::getNumberAllocations(phase) - warmupAllocations[phase];
+    }
+#endif
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    // center of the cape, to compare the results of different runs
+    ParticleStore* particles = cape->getParticles();
+    Vector3 center;
+    for(int i = 0; i < particles->getNumberParticles(); i += 1)
+    {
+        center += particles->getPosition(i);
+    }
+    center = center / particles->getNumberParticles();
+
+    std::cout << "total time                      : " << seconds << " s" << std::endl;
+    std::cout << "time per step                   : " << 1000.0 * seconds / numberSteps << " ms" << std::endl;
+    std::cout << "steps per second                : " << numberSteps / seconds << std::endl;
+    std::cout << "cape center                     : " << center.toString() << std::endl;
+    std::cout << std::endl;
+
+    scene.showSimulationStatus();
+
+    // after the run, so the broadphases it used are counted
+    scene.showMemoryStatus();
+
+    if(checkTriangleContacts)
+    {
+        std::cout << "most triangle contacts in a step: " << mostTriangleContacts << std::endl;
+        std::cout << std::endl;
+
+        if(mostTriangleContacts > particles->getNumberParticles())
+        {
+            std::cerr << "a step had more triangle contacts than nodes" << std::endl;
+            return 1;
+        }
+    }
+
+#ifdef ENABLE_PROFILER
+    Profiler::getInstance()->closeCsv();
+    Profiler::getInstance()->showProfilerStatus();
+#endif
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+    if(checkAllocations)
+    {
+        std::cout << "allocations after warm-up       : " << stepAllocations << std::endl;
+
+        if(stepAllocations != 0)
+        {
+            std::cout << "allocations of each phase after warm-up:" << std::endl;
+            AllocationCounter::showAllocations(phaseAllocations);
+            std::cerr << "the simulation allocated after warm-up" << std::endl;
+            return 1;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+void showUsage()
+{
+    std::cout << "usage: headless [options]" << std::endl;
+    std::cout << "  --help, -h                            show this help" << std::endl;
+    std::cout << "  --scene running|ball                  scene to simulate (default ball)" << std::endl;
+    std::cout << "  --nodes N                             nodes along the width of the cape (default 20)" << std::endl;
+    std::cout << "  --interleaving L                      constraint interleaving levels (default 1, 2 for running)" << std::endl;
+    std::cout << "  --timestep T                          simulated time per step (default from the scene)" << std::endl;
+    std::cout << "  --steps S                             number of steps (default 1000)" << std::endl;
+    std::cout << "  --iterations N                        constraint iterations per step (default 1)" << std::endl;
+    std::cout << "  --threads N                           number of simulation threads" << std::endl;
+    std::cout << "  --solver sequential|colored           constraint solver" << std::endl;
+    std::cout << "  --kernel scalar|sse2|avx2             vectorized kernels" << std::endl;
+    std::cout << "  --self-collision brute|hash|list      self collision broadphase" << std::endl;
+    std::cout << "  --triangle-collision                  enable node-triangle self collision" << std::endl;
+    std::cout << "  --check-triangle-contacts             enable node-triangle self collision, and fail if a step has more contacts than nodes" << std::endl;
+    std::cout << "  --profile-csv FILE                    write the phase times of each step to FILE" << std::endl;
+    std::cout << "  --counters                            count hardware events in each phase" << std::endl;
+    std::cout << "  --check-allocations                   fail if a step allocates after " << ALLOCATION_CHECK_WARMUP_STEPS << " warm-up steps" << std::endl;
+    std::cout << "  --trace FILE                          write a Chrome trace of the run to FILE at exit" << std::endl;
+}
+
+// returns false if the arguments are not valid
+bool parseArguments(int argc, char** argv)
+{
+    SimulationSettings* simulationSettings = SimulationSettings::getInstance();
+
+    for(int i = 1; i < argc; i += 1)
+    {
+        std::string option = argv[i];
+
+        if(option == "--help" || option == "-h")
+        {
+            showUsage();
+            exit(0);
+        }
+
+        if(option == "--triangle-collision")
+        {
+            simulationSettings->setTriangleSelfCollisionEnabled(true);
+            continue;
+        }
+
+        if(option == "--check-triangle-contacts")
+        {
+            simulationSettings->setTriangleSelfCollisionEnabled(true);
+            checkTriangleContacts = true;
+            continue;
+        }
+
+        if(option == "--check-allocations")
+        {
+#ifdef ENABLE_ALLOCATION_COUNTER
+            checkAllocations = true;
+#else
+            std::cerr << "--check-allocations needs a build with ENABLE_ALLOCATION_COUNTER" << std::endl;
+            return false;
+#endif
+            continue;
+        }
+
+        if(option == "--counters")
+        {
+#ifdef ENABLE_PROFILER
+            if(!Profiler::getInstance()->enableCounters())
+            {
+                std::cerr << "hardware counters are not available, timing only" << std::endl;
+            }
+#else
+            std::cerr << "--counters needs a build with ENABLE_PROFILER" << std::endl;
+            return false;
+#endif
+            continue;
+        }
+
+        if(!isValueOption(option))
+        {
+            std::cerr << "unknown option " << option << std::endl;
+            return false;
+        }
+
+        // every other option takes a value
+        if(i + 1 >= argc)
+        {
+            std::cerr << "missing value for " << option << std::endl;
+            return false;
+        }
+
+        std::string value = argv[i + 1];
+        i += 1;
+
+        if(option == "--scene")
+        {
+            if(value != "running" && value != "ball")
+            {
+                std::cerr << "unknown scene " << value << std::endl;
+                return false;
+            }
+
+            runningScene = value == "running";
+        }
+        else if(option == "--nodes")
+        {
+            nodesWidth = atoi(value.c_str());
+        }
+        else if(option == "--interleaving")
+        {
+            interleaving = atoi(value.c_str());
+        }
+        else if(option == "--timestep")
+        {
+            timeStep = atof(value.c_str());
+        }
+        else if(option == "--steps")
+        {
+            numberSteps = atoi(value.c_str());
+        }
+        else if(option == "--iterations")
+        {
+            simulationSettings->setConstraintIterations(atoi(value.c_str()));
+        }
+        else if(option == "--threads")
+        {
+            simulationSettings->setNumberThreads(atoi(value.c_str()));
+        }
+        else if(option == "--solver")
+        {
+            if(value == "sequential")
+            {
+                simulationSettings->setConstraintSolverMode(SEQUENTIAL_SOLVER);
+            }
+            else if(value == "colored")
+            {
+                simulationSettings->setConstraintSolverMode(COLORED_SOLVER);
+            }
+            else
+            {
+                std::cerr << "unknown solver " << value << std::endl;
+                return false;
+            }
+        }
+        else if(option == "--kernel")
+        {
+            if(value == "scalar")
+            {
+                simulationSettings->setSimdKernel(SCALAR_KERNEL);
+            }
+            else if(value == "sse2")
+            {
+                simulationSettings->setSimdKernel(SSE2_KERNEL);
+            }
+            else if(value == "avx2")
+            {
+                simulationSettings->setSimdKernel(AVX2_KERNEL);
+            }
+            else
+            {
+                std::cerr << "unknown kernel " << value << std::endl;
+                return false;
+            }
+        }
+        else if(option == "--self-collision")
+        {
+            if(value == "brute")
+            {
+                simulationSettings->setSelfCollisionMode(BRUTE_FORCE_SELF_COLLISION);
+            }
+            else if(value == "hash")
+            {
+                simulationSettings->setSelfCollisionMode(SPATIAL_HASH_SELF_COLLISION);
+            }
+            else if(value == "list")
+            {
+                simulationSettings->setSelfCollisionMode(NEIGHBOR_LIST_SELF_COLLISION);
+            }
+            else
+            {
+                std::cerr << "unknown self collision mode " << value << std::endl;
+                return false;
+            }
+        }
+        else if(option == "--profile-csv")
+        {
+#ifdef ENABLE_PROFILER
+            if(!Profiler::getInstance()->openCsv(value))
+            {
+                std::cerr << "can not open " << value << std::endl;
+                return false;
+            }
+#else
+            std::cerr << "--profile-csv needs a build with ENABLE_PROFILER" << std::endl;
+            return false;
+#endif
+        }
+        else if(option == "--trace")
+        {
+#ifdef ENABLE_TRACER
+            Tracer::getInstance()->enable(value);
+#else
+            std::cerr << "--trace needs a build with ENABLE_TRACER" << std::endl;
+            return false;
+#endif
+        }
+    }
+
+    if(nodesWidth < 2 || (interleaving != -1 && interleaving < 1) || numberSteps < 0)
+    {
+        std::cerr << "invalid cape size or step count" << std::endl;
+        return false;
+    }
+
+    if(checkAllocations && numberSteps <= ALLOCATION_CHECK_WARMUP_STEPS)
+    {
+        std::cerr << "--check-allocations needs more than " << ALLOCATION_CHECK_WARMUP_STEPS << " steps" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// options followed by a value
+bool isValueOption(std::string option)
+{
+    return option == "--scene"        ||
+           option == "--nodes"        ||
+           option == "--interleaving" ||
+           option == "--timestep"     ||
+           option == "--steps"        ||
+           option == "--iterations"   ||
+           option == "--threads"      ||
+           option == "--solver"       ||
+           option == "--kernel"       ||
+           option == "--self-collision" ||
+           option == "--profile-csv"  ||
+           option == "--trace";
+}
@@ -1,24 +1,57 @@
 // compile with the following command:
-//     clear; g++ -o simulation main.cpp ClothSimulator.cpp Node.cpp Camera.cpp Constraint.cpp StructuralConstraint.cpp ShearConstraint.cpp Arrow.cpp Sphere.cpp Triangle.cpp Cloth.cpp Floor.cpp Scene.cpp BatmanScene.cpp Keyboard.cpp DrawingSettings.cpp -lglut -lGLU -lGL; ./simulation
+//     clear; g++ -O2 -pthread -o simulation main.cpp ClothSimulator.cpp Node.cpp ParticleStore.cpp Camera.cpp Constraint.cpp VerletIntegrator.cpp ColoredConstraintSolver.cpp WorkerPool.cpp SimulationSettings.cpp SimulationScheduler.cpp Sphere.cpp SphereCollider.cpp SphereGrid.cpp SpatialHashGrid.cpp NeighborList.cpp Triangle.cpp TriangleBvh.cpp Cloth.cpp ClothFrame.cpp ClothMesh.cpp VertexBatch.cpp SphereMesh.cpp SphereBatch.cpp RenderPass.cpp Profiler.cpp PerfCounters.cpp AllocationCounter.cpp Tracer.cpp Floor.cpp Scene.cpp BatmanScene.cpp Keyboard.cpp DrawingSettings.cpp -lglut -lGLU -lGL; ./simulation
+//
+// or, with the phase profiler and the Chrome trace:
+//     clear; g++ -O2 -pthread -DENABLE_PROFILER -DENABLE_TRACER -o simulation-profile main.cpp ClothSimulator.cpp Node.cpp ParticleStore.cpp Camera.cpp Constraint.cpp VerletIntegrator.cpp ColoredConstraintSolver.cpp WorkerPool.cpp SimulationSettings.cpp SimulationScheduler.cpp Sphere.cpp SphereCollider.cpp SphereGrid.cpp SpatialHashGrid.cpp NeighborList.cpp Triangle.cpp TriangleBvh.cpp Cloth.cpp ClothFrame.cpp ClothMesh.cpp VertexBatch.cpp SphereMesh.cpp SphereBatch.cpp RenderPass.cpp Profiler.cpp PerfCounters.cpp AllocationCounter.cpp Tracer.cpp Floor.cpp Scene.cpp BatmanScene.cpp Keyboard.cpp DrawingSettings.cpp -lglut -lGLU -lGL; ./simulation-profile
 
 #include "ClothSimulator.h"
 #include "Keyboard.h"
+#include "Profiler.h"
+#include "Tracer.h"
+
+#include <iostream>
+#include <string>
 
 // OpenGL imports
 #include <GL/glut.h>
 #include <GL/gl.h>
 #include <GL/glu.h>
 
+// time between 2 frames, in milliseconds
+#define FRAME_INTERVAL 16
+
+// whether a frame is scheduled. When nothing changes, no frame is scheduled
+// and glut sleeps until the next input
+bool frameScheduled = false;
+
 void display();
 void reshape(int w, int h);
 void normalKeyboardInput(unsigned char key, int x, int y);
 void normalKeyboardRelease(unsigned char key, int x, int y);
 void specialKeyboardInput(int key, int x, int y);
-void applyChanges();
+bool parseArguments(int argc, char** argv);
+void applyChanges(int value);
+void scheduleFrame(int delay);
+void wakeUp();
 
 int main(int argc, char** argv)
 {
     glutInit(&argc, argv);
+
+
+    // glutInit already removed its own options
+    if(!parseArguments(argc, argv))
+    {
+        return 1;
+    }
+
+    TRACE_THREAD_NAME("main");
+
+#ifdef ENABLE_PROFILER
+    // created before the simulation thread can time anything
+    Profiler::getInstance();
+#endif
+
     glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGB);
 
     glutInitWindowSize(400, 400);
@@ -30,8 +63,8 @@ int main(int argc, char** argv)
     ClothSimulator::getInstance()->createScene();
 
     glutDisplayFunc(display);
-    glutIdleFunc(applyChanges);
     glutReshapeFunc(reshape);
+    scheduleFrame(0);
 
     // disable keyboard repeat, because we will use variables for continuous animation
     glutIgnoreKeyRepeat(1);
@@ -44,20 +77,106 @@ int main(int argc, char** argv)
     return 0;
 }
 
-// used for idle callback.
+// options of the profiler and the tracer. Returns false if the arguments
+// are not valid
+bool parseArguments(int argc, char** argv)
+{
+    for(int i = 1; i < argc; i += 1)
+    {
+        std::string option = argv[i];
+
+#ifdef ENABLE_PROFILER
+        if(option == "--counters")
+        {
+            if(!Profiler::getInstance()->enableCounters())
+            {
+                std::cerr << "hardware counters are not available, timing only" << std::endl;
+            }
+
+            continue;
+        }
+#endif
+
+        // every other option takes a file name
+        if(i + 1 >= argc)
+        {
+            std::cerr << "missing value for " << option << std::endl;
+            return false;
+        }
+
+        std::string value = argv[i + 1];
+        i += 1;
+
+#ifdef ENABLE_PROFILER
+        if(option == "--profile-csv")
+        {
+            if(!Profiler::getInstance()->openCsv(value))
+            {
+                std::cerr << "can not open " << value << std::endl;
+                return false;
+            }
+
+            continue;
+        }
+#endif
+
+#ifdef ENABLE_TRACER
+        if(option == "--trace")
+        {
+            Tracer::getInstance()->enable(value);
+            continue;
+        }
+#endif
+
+        std::cerr << "unknown option " << option << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// used for frame timer callback.
 // Will process all changes that occur, such as keyboard commands, new forces, ...
-void applyChanges()
+// The screen is only redrawn, and the next frame only scheduled, when
+// something changed.
+void applyChanges(int)
+{
+    int frameStart = glutGet(GLUT_ELAPSED_TIME);
+    frameScheduled = false;
+
+    if(ClothSimulator::getInstance()->simulate())
+    {
+        // redraw the screen
+        glutPostRedisplay();
+
+        int elapsed = glutGet(GLUT_ELAPSED_TIME) - frameStart;
+        scheduleFrame(elapsed < FRAME_INTERVAL ? FRAME_INTERVAL - elapsed : 0);
+    }
+}
+
+void scheduleFrame(int delay)
 {
-    ClothSimulator::getInstance()->simulate();
+    if(!frameScheduled)
+    {
+        frameScheduled = true;
+        glutTimerFunc(delay, applyChanges, 0);
+    }
+}
 
-    // redraw the screen
+// called after any input, which may have changed the settings or started a
+// continuous action
+void wakeUp()
+{
     glutPostRedisplay();
+    scheduleFrame(0);
 }
 
 // The display function only takes care of drawing.
 // No modifications to any forces, keyboard commands, ... are processed here.
 void display()
 {
+    TRACE_SCOPE("frame");
+
     // clear color buffer
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -89,23 +208,42 @@ void display()
 
     clothSimulator->draw();
 
+#ifdef ENABLE_PROFILER
+    Profiler::getInstance()->drawOverlay();
+    Profiler::getInstance()->endFrame();
+#endif
+
     // swap buffers needed for double buffering
     glutSwapBuffers();
 }
 
+// The keyboard changes settings read by the simulation, which may run on its
+// own thread, so it is locked out while they change.
 void normalKeyboardInput(unsigned char key, int x, int y)
 {
+    ClothSimulator::getInstance()->lockSimulation();
     Keyboard::getInstance()->handleNormalKeyboardInput(key, x, y);
+    ClothSimulator::getInstance()->unlockSimulation();
+
+    wakeUp();
 }
 
 void normalKeyboardRelease(unsigned char key, int x, int y)
 {
+    ClothSimulator::getInstance()->lockSimulation();
     Keyboard::getInstance()->handleNormalKeyboardRelease(key, x, y);
+    ClothSimulator::getInstance()->unlockSimulation();
+
+    wakeUp();
 }
 
 void specialKeyboardInput(int key, int x, int y)
 {
+    ClothSimulator::getInstance()->lockSimulation();
     Keyboard::getInstance()->handleSpecialKeyboardInput(key, x, y);
+    ClothSimulator::getInstance()->unlockSimulation();
+
+    wakeUp();
 }
 
 void reshape(int w, int h)